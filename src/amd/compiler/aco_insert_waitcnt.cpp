@@ -842,9 +842,11 @@ void emit_waitcnt(wait_ctx& ctx, std::vector<aco_ptr<Instruction>>& instructions
    }
 }
 
-void handle_block(Program *program, Block& block, wait_ctx& ctx)
+void handle_block(Program *program, Block& block, wait_ctx& ctx,
+                  std::vector<aco_ptr<Instruction>>& new_instructions)
 {
-   std::vector<aco_ptr<Instruction>> new_instructions;
+   new_instructions.clear();
+   new_instructions.reserve(block.instructions.size());
 
    wait_imm queued_imm;
 
@@ -934,6 +936,9 @@ void insert_wait_states(Program* program)
    std::stack<unsigned> loop_header_indices;
    unsigned loop_progress = 0;
 
+   /* reused for every block to avoid reallocations */
+   std::vector<aco_ptr<Instruction>> instructions;
+
    for (unsigned i = 0; i < program->blocks.size();) {
       Block& current = program->blocks[i++];
       wait_ctx ctx = in_ctx[current.index];
@@ -973,7 +978,7 @@ void insert_wait_states(Program* program)
       loop_progress = std::max<unsigned>(loop_progress, current.loop_nest_depth);
       done[current.index] = true;
 
-      handle_block(program, current, ctx);
+      handle_block(program, current, ctx, instructions);
 
       out_ctx[current.index] = std::move(ctx);
    }
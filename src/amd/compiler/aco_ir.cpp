@@ -30,6 +30,8 @@ namespace aco {
 
 uint64_t debug_flags = 0;
 
+thread_local small_object_pool *instruction_buffer = nullptr;
+
 static const struct debug_control aco_debug_options[] = {
    {"validateir", DEBUG_VALIDATE},
    {"validatera", DEBUG_VALIDATE_RA},
@@ -54,10 +56,24 @@ void init()
    call_once(&init_once_flag, init_once);
 }
 
+Program::~Program()
+{
+   /* Destroy the instructions now, without recycling their memory, which
+    * goes away with instruction_memory right after. */
+   small_object_pool *current = instruction_buffer;
+   instruction_buffer = nullptr;
+   blocks.clear();
+
+   /* don't leave create_instruction() pointing at freed memory */
+   if (current != &instruction_memory)
+      instruction_buffer = current;
+}
+
 void init_program(Program *program, Stage stage, struct radv_shader_info *info,
                   enum chip_class chip_class, enum radeon_family family,
                   ac_shader_config *config)
 {
+   instruction_buffer = &program->instruction_memory;
    program->stage = stage;
    program->config = config;
    program->info = info;
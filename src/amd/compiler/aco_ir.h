@@ -1295,9 +1295,19 @@ struct Pseudo_reduction_instruction : public Instruction {
 };
 static_assert(sizeof(Pseudo_reduction_instruction) == sizeof(Instruction) + 4, "Unexpected padding");
 
+/* Instructions are allocated from the instruction_memory of the Program
+ * being compiled on this thread, which init_program() sets and ~Program()
+ * resets. Deleted instructions give their memory back to it for reuse, it
+ * is all freed at once when the Program is destroyed. */
+extern thread_local aco::small_object_pool *instruction_buffer;
+
 struct instr_deleter_functor {
    void operator()(void* p) {
-      free(p);
+      /* NULL while ~Program() destroys the instructions */
+      if (instruction_buffer) {
+         Instruction *instr = (Instruction*)p;
+         instruction_buffer->deallocate(p, (char*)instr->definitions.end() - (char*)p);
+      }
    }
 };
 
@@ -1307,8 +1317,12 @@ using aco_ptr = std::unique_ptr<T, instr_deleter_functor>;
 template<typename T>
 T* create_instruction(aco_opcode opcode, Format format, uint32_t num_operands, uint32_t num_definitions)
 {
+   static_assert(alignof(T) <= aco::small_object_pool::granularity, "Unexpected alignment");
+   assert(instruction_buffer && "create_instruction() called without a Program, see init_program()");
+
    std::size_t size = sizeof(T) + num_operands * sizeof(Operand) + num_definitions * sizeof(Definition);
-   char *data = (char*) calloc(1, size);
+   char *data = (char*) instruction_buffer->allocate(size);
+   memset(data, 0, size);
    T* inst = (T*) data;
 
    inst->opcode = opcode;
@@ -1539,6 +1553,8 @@ enum statistic {
 
 class Program final {
 public:
+   /* Declared first so that it outlives anything pointing into it. */
+   aco::small_object_pool instruction_memory{65536};
    float_mode next_fp_mode;
    std::vector<Block> blocks;
    RegisterDemand max_reg_demand = RegisterDemand();
@@ -1609,6 +1625,8 @@ public:
       return &blocks.back();
    }
 
+   ~Program();
+
 private:
    uint32_t allocationID = 1;
 };
@@ -342,6 +342,9 @@ struct vn_ctx {
     */
    uint32_t exec_id = 1;
 
+   /* reused for every block to avoid reallocations */
+   std::vector<aco_ptr<Instruction>> instructions;
+
    vn_ctx(Program* program) : program(program) {
       static_assert(sizeof(Temp) == 4, "Temp must fit in 32bits");
       unsigned size = 0;
@@ -366,7 +369,8 @@ bool dominates(vn_ctx& ctx, uint32_t parent, uint32_t child)
 
 void process_block(vn_ctx& ctx, Block& block)
 {
-   std::vector<aco_ptr<Instruction>> new_instructions;
+   std::vector<aco_ptr<Instruction>>& new_instructions = ctx.instructions;
+   new_instructions.clear();
    new_instructions.reserve(block.instructions.size());
 
    for (aco_ptr<Instruction>& instr : block.instructions) {
@@ -428,7 +432,7 @@ void process_block(vn_ctx& ctx, Block& block)
       }
    }
 
-   block.instructions = std::move(new_instructions);
+   block.instructions.swap(new_instructions);
 }
 
 void rename_phi_operands(Block& block, std::map<uint32_t, Temp>& renames)
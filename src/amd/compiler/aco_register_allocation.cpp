@@ -74,6 +74,7 @@ struct ra_ctx {
    unsigned max_used_sgpr = 0;
    unsigned max_used_vgpr = 0;
    std::bitset<64> defs_done; /* see MAX_ARGS in aco_instruction_selection_setup.cpp */
+   std::vector<aco_ptr<Instruction>> instructions; /* reused for every block */
 
    ra_ctx(Program* program) : program(program),
                               assignments(program->peekAllocationId()),
@@ -1794,8 +1795,10 @@ void register_allocation(Program *program, std::vector<TempSet>& live_out_per_bl
             register_file.fill(Definition(renamed.id(), var.reg, var.rc));
       }
 
-      std::vector<aco_ptr<Instruction>> instructions;
+      std::vector<aco_ptr<Instruction>>& instructions = ctx.instructions;
       std::vector<aco_ptr<Instruction>>::iterator it;
+      instructions.clear();
+      instructions.reserve(block.instructions.size());
 
       /* this is a slight adjustment from the paper as we already have phi nodes:
        * We consider them incomplete phis and only handle the definition. */
@@ -2372,7 +2375,7 @@ void register_allocation(Program *program, std::vector<TempSet>& live_out_per_bl
 
       } /* end for Instr */
 
-      block.instructions = std::move(instructions);
+      block.instructions.swap(instructions);
 
       ctx.filled[block.index] = true;
       for (unsigned succ_idx : block.linear_succs) {
@@ -26,6 +26,9 @@
 #define ACO_UTIL_H
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <iterator>
 
 namespace aco {
@@ -228,6 +231,156 @@ private:
    size_type length{ 0 };     //!> Size of the span
 };
 
+/*! \brief      Definition of a monotonic buffer resource
+*
+*   \details    A "monotonic_buffer_resource" hands out memory by bumping a
+*               pointer through a chain of buffers. Individual allocations are
+*               never freed; all memory is returned at once by release() or
+*               by the destructor. Each new buffer is twice the size of the
+*               previous one. It is similar to std::pmr::monotonic_buffer_resource
+*               but does not depend on C++17, and it is not thread-safe.
+*/
+class monotonic_buffer_resource final {
+public:
+   /*! \brief                 Constructor taking the size of the first buffer
+   *   \param[in]   size      Size of the first buffer in bytes
+   */
+   explicit monotonic_buffer_resource(size_t size = initial_size)
+      : first_size{ size < minimum_size ? minimum_size : size } {}
+
+   monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+   monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+   /*! \brief                 Destructor releasing all buffers
+   */
+   ~monotonic_buffer_resource() {
+      release();
+   }
+
+   /*! \brief                 Allocates uninitialized memory
+   *   \param[in]   size      Size of the allocation in bytes
+   *   \param[in]   alignment Alignment of the allocation, a power of two no
+   *                          larger than alignof(std::max_align_t)
+   *   \return                Pointer to the memory, valid until release()
+   */
+   void *allocate(size_t size, size_t alignment) {
+      assert(alignment && (alignment & (alignment - 1)) == 0);
+      size_t offset = (used + alignment - 1) & ~(alignment - 1);
+      if (!buffer || offset + size > buffer->size) {
+         new_buffer(size);
+         offset = 0;
+      }
+      used = offset + size;
+      return buffer->data() + offset;
+   }
+
+   /*! \brief                 Frees all buffers at once
+   */
+   void release() noexcept {
+      while (buffer) {
+         Buffer *next = buffer->next;
+         free(buffer);
+         buffer = next;
+      }
+      used = 0;
+   }
+
+private:
+   struct Buffer {
+      Buffer *next;
+      size_t size;         //!> Usable size, excluding this header
+      alignas(std::max_align_t) uint8_t first_byte;
+
+      uint8_t *data() noexcept {
+         return &first_byte;
+      }
+   };
+
+   void new_buffer(size_t min_size) {
+      size_t size = buffer ? buffer->size * 2 : first_size;
+      while (size < min_size)
+         size *= 2;
+
+      Buffer *next = (Buffer*)malloc(offsetof(Buffer, first_byte) + size);
+      if (!next)
+         abort();
+      next->next = buffer;
+      next->size = size;
+      buffer = next;
+   }
+
+   static constexpr size_t initial_size = 16384;
+   static constexpr size_t minimum_size = 64;
+
+   Buffer *buffer{ nullptr };   //!> Current buffer, linked to the previous ones
+   size_t used{ 0 };            //!> Bytes used in the current buffer
+   size_t first_size;           //!> Size of the first buffer
+};
+
+/*! \brief      Definition of a pool resource for small allocations
+*
+*   \details    A "small_object_pool" hands out memory from a
+*               monotonic_buffer_resource. Memory given back with deallocate()
+*               is kept on a free list per size and reused by later allocations
+*               of the same size; it is only returned to the system by the
+*               destructor. All allocations are aligned to \p granularity.
+*               It is not thread-safe.
+*/
+class small_object_pool final {
+public:
+   static constexpr size_t granularity = 8;
+
+   /*! \brief                 Constructor taking the size of the first buffer
+   *   \param[in]   size      Size of the first buffer in bytes
+   */
+   explicit small_object_pool(size_t size) : memory{ size } {}
+
+   small_object_pool(const small_object_pool&) = delete;
+   small_object_pool& operator=(const small_object_pool&) = delete;
+
+   /*! \brief                 Allocates uninitialized memory
+   *   \param[in]   size      Size of the allocation in bytes
+   *   \return                Pointer to the memory, aligned to granularity
+   */
+   void *allocate(size_t size) {
+      size_t bucket = bucket_index(size);
+      if (bucket < num_buckets && free_lists[bucket]) {
+         Node *node = free_lists[bucket];
+         free_lists[bucket] = node->next;
+         return node;
+      }
+      return memory.allocate(bucket * granularity, granularity);
+   }
+
+   /*! \brief                 Gives memory back for reuse
+   *   \param[in]   p         Pointer returned by allocate()
+   *   \param[in]   size      Size which was passed to allocate()
+   */
+   void deallocate(void *p, size_t size) noexcept {
+      size_t bucket = bucket_index(size);
+      if (bucket > 0 && bucket < num_buckets) {
+         Node *node = (Node*)p;
+         node->next = free_lists[bucket];
+         free_lists[bucket] = node;
+      }
+   }
+
+private:
+   struct Node {
+      Node *next;
+   };
+
+   static size_t bucket_index(size_t size) noexcept {
+      return (size + granularity - 1) / granularity;
+   }
+
+   /* Larger allocations are not reused, they are rare. */
+   static constexpr size_t num_buckets = 64;
+
+   monotonic_buffer_resource memory;
+   Node *free_lists[num_buckets] = {};
+};
+
 } // namespace aco
 
 #endif // ACO_UTIL_H
@@ -7635,7 +7635,15 @@ builtin_builder::_helper_invocation()
 
 /******************************************************************************/
 
-/* The singleton instance of builtin_builder. */
+/**
+ * The singleton instance of builtin_builder.
+ *
+ * builtins_lock only serializes initialize() and release().  Once built,
+ * the built-in shader and its symbol table are never modified again, and
+ * every caller of the lookup functions below holds a reference taken with
+ * _mesa_glsl_builtin_functions_init_or_ref(), so lookups from concurrent
+ * compiles need no locking.
+ */
 static builtin_builder builtins;
 static mtx_t builtins_lock = _MTX_INITIALIZER_NP;
 static uint32_t builtin_users = 0;
@@ -7667,32 +7675,22 @@ ir_function_signature *
 _mesa_glsl_find_builtin_function(_mesa_glsl_parse_state *state,
                                  const char *name, exec_list *actual_parameters)
 {
-   ir_function_signature *s;
-   mtx_lock(&builtins_lock);
-   s = builtins.find(state, name, actual_parameters);
-   mtx_unlock(&builtins_lock);
-
-   return s;
+   return builtins.find(state, name, actual_parameters);
 }
 
 bool
 _mesa_glsl_has_builtin_function(_mesa_glsl_parse_state *state, const char *name)
 {
-   ir_function *f;
-   bool ret = false;
-   mtx_lock(&builtins_lock);
-   f = builtins.shader->symbols->get_function(name);
-   if (f != NULL) {
-      foreach_in_list(ir_function_signature, sig, &f->signatures) {
-         if (sig->is_builtin_available(state)) {
-            ret = true;
-            break;
-         }
-      }
+   ir_function *f = builtins.shader->symbols->get_function(name);
+   if (f == NULL)
+      return false;
+
+   foreach_in_list(ir_function_signature, sig, &f->signatures) {
+      if (sig->is_builtin_available(state))
+         return true;
    }
-   mtx_unlock(&builtins_lock);
 
-   return ret;
+   return false;
 }
 
 gl_shader *
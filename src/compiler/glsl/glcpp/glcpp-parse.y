@@ -1128,8 +1128,11 @@ _token_list_copy(glcpp_parser_t *parser, token_list_t *other)
    if (other == NULL)
       return NULL;
 
+   /* Stop at the tail, (which need not end the chain of nodes if 'other'
+    * has since been appended to another list). */
    copy = _token_list_create (parser);
-   for (node = other->head; node; node = node->next) {
+   for (node = other->head; node;
+        node = node == other->tail ? NULL : node->next) {
       token_t *new_token = linear_alloc_child(parser->linalloc, sizeof(token_t));
       *new_token = *node->token;
       _token_list_append (parser, copy, new_token);
@@ -1837,26 +1840,26 @@ _glcpp_parser_apply_pastes(glcpp_parser_t *parser, token_list_t *list)
  * expansion. Specifically, *last will be set as follows: as the
  * token of the closing right parenthesis.
  *
+ * 'macro' is the function-like macro that node's identifier names, as
+ * already looked up by the caller.
+ *
  * See the documentation of _glcpp_parser_expand_token_list for a description
  * of the "mode" parameter.
  */
 static token_list_t *
 _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
-                              token_node_t **last, expansion_mode_t mode)
+                              macro_t *macro, token_node_t **last,
+                              expansion_mode_t mode)
 {
-   struct hash_entry *entry;
-   macro_t *macro;
    const char *identifier;
    argument_list_t *arguments;
    function_status_t status;
    token_list_t *substituted;
+   token_list_t **expanded_arguments;
    int parameter_index;
 
    identifier = node->token->value.str;
 
-   entry = _mesa_hash_table_search(parser->defines, identifier);
-   macro = entry ? entry->data : NULL;
-
    assert(macro->is_function);
 
    arguments = _argument_list_create(parser);
@@ -1889,6 +1892,15 @@ _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
       return NULL;
    }
 
+   /* Each argument is expanded at most once, however many times its
+    * parameter appears in the replacement list. The first occurrence is
+    * substituted with the expansion itself, later ones with a copy of it,
+    * (its nodes stay intact until pastes are applied below). */
+   expanded_arguments =
+      linear_zalloc_child(parser->linalloc,
+                          _string_list_length(macro->parameters) *
+                          sizeof(token_list_t *));
+
    /* Perform argument substitution on the replacement list. */
    substituted = _token_list_create(parser);
 
@@ -1902,8 +1914,15 @@ _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
           * placeholder token for an empty argument. */
          if (argument->head) {
             token_list_t *expanded_argument;
-            expanded_argument = _token_list_copy(parser, argument);
-            _glcpp_parser_expand_token_list(parser, expanded_argument, mode);
+            expanded_argument = expanded_arguments[parameter_index];
+            if (expanded_argument == NULL) {
+               expanded_argument = _token_list_copy(parser, argument);
+               _glcpp_parser_expand_token_list(parser, expanded_argument,
+                                               mode);
+               expanded_arguments[parameter_index] = expanded_argument;
+            } else {
+               expanded_argument = _token_list_copy(parser, expanded_argument);
+            }
             _token_list_append_list(substituted, expanded_argument);
          } else {
             token_t *new_token;
@@ -2010,7 +2029,7 @@ _glcpp_parser_expand_node(glcpp_parser_t *parser, token_node_t *node,
       return replacement;
    }
 
-   return _glcpp_parser_expand_function(parser, node, last, mode);
+   return _glcpp_parser_expand_function(parser, node, macro, last, mode);
 }
 
 /* Push a new identifier onto the parser's active list.
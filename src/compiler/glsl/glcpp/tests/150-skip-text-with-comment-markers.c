@@ -0,0 +1,4 @@
+#if 0
+string "/*" and a = b * c / d; // #endif
+#endif
+SUCCESS
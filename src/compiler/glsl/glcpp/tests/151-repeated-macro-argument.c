@@ -0,0 +1,5 @@
+#define twice(x) x x
+#define inc(x) (x + 1)
+twice(inc(1))
+#define glue(x) x ## x
+glue(ab)
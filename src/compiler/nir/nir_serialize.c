@@ -78,6 +78,9 @@ typedef struct {
    /* map from index to deserialized pointer */
    void **idx_table;
 
+   /* The function implementation being read. */
+   nir_function_impl *impl;
+
    /* List of phi sources. */
    struct list_head phi_srcs;
 
@@ -110,6 +113,39 @@ read_add_object(read_ctx *ctx, void *obj)
    ctx->idx_table[ctx->next_idx++] = obj;
 }
 
+/* Inlined blob_read_uint16/32() for the per-instruction paths.  These are
+ * called several times for every instruction, so the out-of-line call is a
+ * large part of the deserialization cost.  Anything but the in-bounds case
+ * is left to the blob functions so overrun handling stays the same.
+ */
+static inline uint32_t
+read_uint32(read_ctx *ctx)
+{
+   struct blob_reader *blob = ctx->blob;
+   const uint8_t *cur = blob->data + align64(blob->current - blob->data, 4);
+
+   if (likely(!blob->overrun && cur <= blob->end && blob->end - cur >= 4)) {
+      blob->current = cur + 4;
+      return *(const uint32_t *)cur;
+   }
+
+   return blob_read_uint32(blob);
+}
+
+static inline uint16_t
+read_uint16(read_ctx *ctx)
+{
+   struct blob_reader *blob = ctx->blob;
+   const uint8_t *cur = blob->data + align64(blob->current - blob->data, 2);
+
+   if (likely(!blob->overrun && cur <= blob->end && blob->end - cur >= 2)) {
+      blob->current = cur + 2;
+      return *(const uint16_t *)cur;
+   }
+
+   return blob_read_uint16(blob);
+}
+
 static void *
 read_lookup_object(read_ctx *ctx, uint32_t idx)
 {
@@ -120,7 +156,7 @@ read_lookup_object(read_ctx *ctx, uint32_t idx)
 static void *
 read_object(read_ctx *ctx)
 {
-   return read_lookup_object(ctx, blob_read_uint32(ctx->blob));
+   return read_lookup_object(ctx, read_uint32(ctx));
 }
 
 static uint32_t
@@ -186,7 +222,7 @@ read_constant(read_ctx *ctx, nir_variable *nvar)
    nir_constant *c = ralloc(nvar, nir_constant);
 
    blob_copy_bytes(ctx->blob, (uint8_t *)c->values, sizeof(c->values));
-   c->num_elements = blob_read_uint32(ctx->blob);
+   c->num_elements = read_uint32(ctx);
    c->elements = ralloc_array(nvar, nir_constant *, c->num_elements);
    for (unsigned i = 0; i < c->num_elements; i++)
       c->elements[i] = read_constant(ctx, nvar);
@@ -339,7 +375,7 @@ read_variable(read_ctx *ctx)
    read_add_object(ctx, var);
 
    union packed_var flags;
-   flags.u32 = blob_read_uint32(ctx->blob);
+   flags.u32 = read_uint32(ctx);
 
    if (flags.u.type_same_as_last) {
       var->type = ctx->last_type;
@@ -373,7 +409,7 @@ read_variable(read_ctx *ctx)
       ctx->last_var_data = var->data;
    } else { /* var_encode_location_diff */
       union packed_var_data_diff diff;
-      diff.u32 = blob_read_uint32(ctx->blob);
+      diff.u32 = read_uint32(ctx);
 
       var->data = ctx->last_var_data;
       var->data.location += diff.u.location;
@@ -426,7 +462,7 @@ static void
 read_var_list(read_ctx *ctx, struct exec_list *dst)
 {
    exec_list_make_empty(dst);
-   unsigned num_vars = blob_read_uint32(ctx->blob);
+   unsigned num_vars = read_uint32(ctx);
    for (unsigned i = 0; i < num_vars; i++) {
       nir_variable *var = read_variable(ctx);
       exec_list_push_tail(dst, &var->node);
@@ -451,11 +487,11 @@ read_register(read_ctx *ctx)
 {
    nir_register *reg = ralloc(ctx->nir, nir_register);
    read_add_object(ctx, reg);
-   reg->num_components = blob_read_uint32(ctx->blob);
-   reg->bit_size = blob_read_uint32(ctx->blob);
-   reg->num_array_elems = blob_read_uint32(ctx->blob);
-   reg->index = blob_read_uint32(ctx->blob);
-   bool has_name = blob_read_uint32(ctx->blob);
+   reg->num_components = read_uint32(ctx);
+   reg->bit_size = read_uint32(ctx);
+   reg->num_array_elems = read_uint32(ctx);
+   reg->index = read_uint32(ctx);
+   bool has_name = read_uint32(ctx);
    if (has_name) {
       const char *name = blob_read_string(ctx->blob);
       reg->name = ralloc_strdup(reg, name);
@@ -482,7 +518,7 @@ static void
 read_reg_list(read_ctx *ctx, struct exec_list *dst)
 {
    exec_list_make_empty(dst);
-   unsigned num_regs = blob_read_uint32(ctx->blob);
+   unsigned num_regs = read_uint32(ctx);
    for (unsigned i = 0; i < num_regs; i++) {
       nir_register *reg = read_register(ctx);
       exec_list_push_tail(dst, &reg->node);
@@ -550,14 +586,14 @@ read_src(read_ctx *ctx, nir_src *src, void *mem_ctx)
 {
    STATIC_ASSERT(sizeof(union packed_src) == 4);
    union packed_src header;
-   header.u32 = blob_read_uint32(ctx->blob);
+   header.u32 = read_uint32(ctx);
 
    src->is_ssa = header.any.is_ssa;
    if (src->is_ssa) {
       src->ssa = read_lookup_object(ctx, header.any.object_idx);
    } else {
       src->reg.reg = read_lookup_object(ctx, header.any.object_idx);
-      src->reg.base_offset = blob_read_uint32(ctx->blob);
+      src->reg.base_offset = read_uint32(ctx);
       if (header.any.is_indirect) {
          src->reg.indirect = ralloc(mem_ctx, nir_src);
          read_src(ctx, src->reg.indirect, mem_ctx);
@@ -770,7 +806,7 @@ read_dest(read_ctx *ctx, nir_dest *dst, nir_instr *instr,
       unsigned bit_size = decode_bit_size_3bits(dest.ssa.bit_size);
       unsigned num_components;
       if (dest.ssa.num_components == NUM_COMPONENTS_IS_SEPARATE_7)
-         num_components = blob_read_uint32(ctx->blob);
+         num_components = read_uint32(ctx);
       else
          num_components = decode_num_components_in_3bits(dest.ssa.num_components);
       char *name = dest.ssa.has_name ? blob_read_string(ctx->blob) : NULL;
@@ -778,7 +814,7 @@ read_dest(read_ctx *ctx, nir_dest *dst, nir_instr *instr,
       read_add_object(ctx, &dst->ssa);
    } else {
       dst->reg.reg = read_object(ctx);
-      dst->reg.base_offset = blob_read_uint32(ctx->blob);
+      dst->reg.base_offset = read_uint32(ctx);
       if (dest.reg.is_indirect) {
          dst->reg.indirect = ralloc(instr, nir_src);
          read_src(ctx, dst->reg.indirect, instr);
@@ -919,14 +955,14 @@ read_alu(read_ctx *ctx, union packed_instr header)
    } else if (dst_components <= 4) {
       alu->dest.write_mask = header.alu.writemask_or_two_swizzles;
    } else {
-      alu->dest.write_mask = blob_read_uint32(ctx->blob);
+      alu->dest.write_mask = read_uint32(ctx);
    }
 
    if (header.alu.packed_src_ssa_16bit) {
       for (unsigned i = 0; i < num_srcs; i++) {
          nir_alu_src *src = &alu->src[i];
          src->src.is_ssa = true;
-         src->src.ssa = read_lookup_object(ctx, blob_read_uint16(ctx->blob));
+         src->src.ssa = read_lookup_object(ctx, read_uint16(ctx));
 
          memset(&src->swizzle, 0, sizeof(src->swizzle));
 
@@ -955,7 +991,7 @@ read_alu(read_ctx *ctx, union packed_instr header)
          } else {
             /* Load swizzles for vec8 and vec16. */
             for (unsigned o = 0; o < src_channels; o += 8) {
-               unsigned value = blob_read_uint32(ctx->blob);
+               unsigned value = read_uint32(ctx);
 
                for (unsigned j = 0; j < 8 && o + j < src_channels; j++) {
                   alu->src[i].swizzle[o + j] =
@@ -976,6 +1012,42 @@ read_alu(read_ctx *ctx, union packed_instr header)
    return alu;
 }
 
+/* Equivalent to nir_instr_insert_after_block() for an ALU instruction that
+ * was just read.  ALU instructions are the bulk of most shaders, so the
+ * all-SSA case registers its uses and def directly rather than through the
+ * generic nir_foreach_src/dest/ssa_def walks.
+ */
+static void
+read_insert_alu(read_ctx *ctx, nir_block *block, nir_alu_instr *alu)
+{
+   unsigned num_srcs = nir_op_infos[alu->op].num_inputs;
+
+   if (!alu->dest.dest.is_ssa) {
+      nir_instr_insert_after_block(block, &alu->instr);
+      return;
+   }
+
+   for (unsigned i = 0; i < num_srcs; i++) {
+      if (!alu->src[i].src.is_ssa) {
+         nir_instr_insert_after_block(block, &alu->instr);
+         return;
+      }
+   }
+
+   alu->instr.block = block;
+
+   for (unsigned i = 0; i < num_srcs; i++) {
+      nir_src *src = &alu->src[i].src;
+      src->parent_instr = &alu->instr;
+      list_addtail(&src->use_link, &src->ssa->uses);
+   }
+
+   assert(alu->dest.dest.ssa.index == UINT_MAX);
+   alu->dest.dest.ssa.index = ctx->impl->ssa_alloc++;
+
+   exec_list_push_tail(&block->instr_list, &alu->instr.node);
+}
+
 static void
 write_deref(write_ctx *ctx, const nir_deref_instr *deref)
 {
@@ -1074,7 +1146,7 @@ read_deref(read_ctx *ctx, union packed_instr header)
    case nir_deref_type_struct:
       read_src(ctx, &deref->parent, &deref->instr);
       parent = nir_src_as_deref(deref->parent);
-      deref->strct.index = blob_read_uint32(ctx->blob);
+      deref->strct.index = read_uint32(ctx);
       deref->type = glsl_get_struct_field(parent->type, deref->strct.index);
       break;
 
@@ -1082,9 +1154,9 @@ read_deref(read_ctx *ctx, union packed_instr header)
    case nir_deref_type_ptr_as_array:
       if (header.deref.packed_src_ssa_16bit) {
          deref->parent.is_ssa = true;
-         deref->parent.ssa = read_lookup_object(ctx, blob_read_uint16(ctx->blob));
+         deref->parent.ssa = read_lookup_object(ctx, read_uint16(ctx));
          deref->arr.index.is_ssa = true;
-         deref->arr.index.ssa = read_lookup_object(ctx, blob_read_uint16(ctx->blob));
+         deref->arr.index.ssa = read_lookup_object(ctx, read_uint16(ctx));
       } else {
          read_src(ctx, &deref->parent, &deref->instr);
          read_src(ctx, &deref->arr.index, &deref->instr);
@@ -1099,7 +1171,7 @@ read_deref(read_ctx *ctx, union packed_instr header)
 
    case nir_deref_type_cast:
       read_src(ctx, &deref->parent, &deref->instr);
-      deref->cast.ptr_stride = blob_read_uint32(ctx->blob);
+      deref->cast.ptr_stride = read_uint32(ctx);
       if (header.deref.cast_type_same_as_last) {
          deref->type = ctx->last_type;
       } else {
@@ -1244,11 +1316,11 @@ read_intrinsic(read_ctx *ctx, union packed_instr header)
          break;
       case const_indices_16bit:
          for (unsigned i = 0; i < num_indices; i++)
-            intrin->const_index[i] = blob_read_uint16(ctx->blob);
+            intrin->const_index[i] = read_uint16(ctx);
          break;
       case const_indices_32bit:
          for (unsigned i = 0; i < num_indices; i++)
-            intrin->const_index[i] = blob_read_uint32(ctx->blob);
+            intrin->const_index[i] = read_uint32(ctx);
          break;
       }
    }
@@ -1391,12 +1463,12 @@ read_load_const(read_ctx *ctx, union packed_instr header)
 
       case 32:
          for (unsigned i = 0; i < lc->def.num_components; i++)
-            lc->value[i].u32 = blob_read_uint32(ctx->blob);
+            lc->value[i].u32 = read_uint32(ctx);
          break;
 
       case 16:
          for (unsigned i = 0; i < lc->def.num_components; i++)
-            lc->value[i].u16 = blob_read_uint16(ctx->blob);
+            lc->value[i].u16 = read_uint16(ctx);
          break;
 
       default:
@@ -1505,13 +1577,13 @@ read_tex(read_ctx *ctx, union packed_instr header)
    read_dest(ctx, &tex->dest, &tex->instr, header);
 
    tex->op = header.tex.op;
-   tex->texture_index = blob_read_uint32(ctx->blob);
-   tex->sampler_index = blob_read_uint32(ctx->blob);
+   tex->texture_index = read_uint32(ctx);
+   tex->sampler_index = read_uint32(ctx);
    if (tex->op == nir_texop_tg4)
       blob_copy_bytes(ctx->blob, tex->tg4_offsets, sizeof(tex->tg4_offsets));
 
    union packed_tex_data packed;
-   packed.u32 = blob_read_uint32(ctx->blob);
+   packed.u32 = read_uint32(ctx);
    tex->sampler_dim = packed.u.sampler_dim;
    tex->dest_type = packed.u.dest_type;
    tex->coord_components = packed.u.coord_components;
@@ -1593,8 +1665,8 @@ read_phi(read_ctx *ctx, nir_block *blk, union packed_instr header)
       nir_phi_src *src = ralloc(phi, nir_phi_src);
 
       src->src.is_ssa = true;
-      src->src.ssa = (nir_ssa_def *)(uintptr_t) blob_read_uint32(ctx->blob);
-      src->pred = (nir_block *)(uintptr_t) blob_read_uint32(ctx->blob);
+      src->src.ssa = (nir_ssa_def *)(uintptr_t) read_uint32(ctx);
+      src->pred = (nir_block *)(uintptr_t) read_uint32(ctx);
 
       /* Since we're not letting nir_insert_instr handle use/def stuff for us,
        * we have to set the parent_instr manually.  It doesn't really matter
@@ -1718,13 +1790,13 @@ read_instr(read_ctx *ctx, nir_block *block)
 {
    STATIC_ASSERT(sizeof(union packed_instr) == 4);
    union packed_instr header;
-   header.u32 = blob_read_uint32(ctx->blob);
+   header.u32 = read_uint32(ctx);
    nir_instr *instr;
 
    switch (header.any.instr_type) {
    case nir_instr_type_alu:
       for (unsigned i = 0; i <= header.alu.num_followup_alu_sharing_header; i++)
-         nir_instr_insert_after_block(block, &read_alu(ctx, header)->instr);
+         read_insert_alu(ctx, block, read_alu(ctx, header));
       return header.alu.num_followup_alu_sharing_header + 1;
    case nir_instr_type_deref:
       instr = &read_deref(ctx, header)->instr;
@@ -1791,7 +1863,7 @@ read_block(read_ctx *ctx, struct exec_list *cf_list)
       exec_node_data(nir_block, exec_list_get_tail(cf_list), cf_node.node);
 
    read_add_object(ctx, block);
-   unsigned num_instrs = blob_read_uint32(ctx->blob);
+   unsigned num_instrs = read_uint32(ctx);
    for (unsigned i = 0; i < num_instrs;) {
       i += read_instr(ctx, block);
    }
@@ -1864,7 +1936,7 @@ write_cf_node(write_ctx *ctx, nir_cf_node *cf)
 static void
 read_cf_node(read_ctx *ctx, struct exec_list *list)
 {
-   nir_cf_node_type type = blob_read_uint32(ctx->blob);
+   nir_cf_node_type type = read_uint32(ctx);
 
    switch (type) {
    case nir_cf_node_block:
@@ -1893,7 +1965,7 @@ write_cf_list(write_ctx *ctx, const struct exec_list *cf_list)
 static void
 read_cf_list(read_ctx *ctx, struct exec_list *cf_list)
 {
-   uint32_t num_cf_nodes = blob_read_uint32(ctx->blob);
+   uint32_t num_cf_nodes = read_uint32(ctx);
    for (unsigned i = 0; i < num_cf_nodes; i++)
       read_cf_node(ctx, cf_list);
 }
@@ -1921,8 +1993,9 @@ read_function_impl(read_ctx *ctx, nir_function *fxn)
 
    read_var_list(ctx, &fi->locals);
    read_reg_list(ctx, &fi->registers);
-   fi->reg_alloc = blob_read_uint32(ctx->blob);
+   fi->reg_alloc = read_uint32(ctx);
 
+   ctx->impl = fi;
    read_cf_list(ctx, &fi->body);
    read_fixup_phis(ctx);
 
@@ -1963,7 +2036,7 @@ write_function(write_ctx *ctx, const nir_function *fxn)
 static void
 read_function(read_ctx *ctx)
 {
-   uint32_t flags = blob_read_uint32(ctx->blob);
+   uint32_t flags = read_uint32(ctx);
    bool has_name = flags & 0x2;
    char *name = has_name ? blob_read_string(ctx->blob) : NULL;
 
@@ -1971,10 +2044,10 @@ read_function(read_ctx *ctx)
 
    read_add_object(ctx, fxn);
 
-   fxn->num_params = blob_read_uint32(ctx->blob);
+   fxn->num_params = read_uint32(ctx);
    fxn->params = ralloc_array(fxn, nir_parameter, fxn->num_params);
    for (unsigned i = 0; i < fxn->num_params; i++) {
-      uint32_t val = blob_read_uint32(ctx->blob);
+      uint32_t val = read_uint32(ctx);
       fxn->params[i].num_components = val & 0xff;
       fxn->params[i].bit_size = (val >> 8) & 0xff;
    }
@@ -26,6 +26,7 @@
 #include "nir.h"
 #include "nir_builder.h"
 #include "nir_serialize.h"
+#include "util/os_time.h"
 
 namespace {
 
@@ -104,6 +105,34 @@ nir_serialize_test::ASSERT_SWIZZLE_EQ(nir_alu_instr *a, nir_alu_instr *b, unsign
 class nir_serialize_all_test : public nir_serialize_test {};
 class nir_serialize_all_but_one_test : public nir_serialize_test {};
 
+class nir_serialize_large_test : public nir_serialize_test {
+protected:
+   void build_large_shader();
+};
+
+/* A large shader that is mostly ALU, like the ones coming out of the disk
+ * cache.
+ */
+void
+nir_serialize_large_test::build_large_shader()
+{
+   nir_ssa_def *v = nir_imm_zero(b, 4, 32);
+   nir_ssa_def *acc = nir_load_local_invocation_id(b);
+
+   for (unsigned i = 0; i < 4096; i++) {
+      nir_ssa_def *x = nir_ffma(b, v, v, nir_imm_float(b, i));
+      acc = nir_iadd(b, acc, nir_channels(b, nir_f2i32(b, x), 0x7));
+
+      if (i % 64 == 0) {
+         nir_if *nif =
+            nir_push_if(b, nir_ieq(b, nir_channel(b, acc, 0), nir_imm_int(b, i)));
+         nir_ssa_def *neg = nir_ineg(b, acc);
+         nir_pop_if(b, nif);
+         acc = nir_if_phi(b, neg, acc);
+      }
+   }
+}
+
 } // namespace
 
 #if NIR_MAX_VEC_COMPONENTS == 16
@@ -282,3 +311,77 @@ TEST_P(nir_serialize_all_but_one_test, single_channel)
 
    ASSERT_SWIZZLE_EQ(vec_alu, vec_alu_dup, 1, 0);
 }
+
+/* Checks that the use/def lists and SSA indices of the deserialized large
+ * shader match the original.
+ */
+TEST_F(nir_serialize_large_test, use_def)
+{
+   build_large_shader();
+   serialize();
+   nir_validate_shader(dup, "cloned");
+
+   nir_function_impl *impl = nir_shader_get_entrypoint(b->shader);
+   nir_function_impl *dup_impl = nir_shader_get_entrypoint(dup);
+   ASSERT_EQ(impl->ssa_alloc, dup_impl->ssa_alloc);
+
+   nir_block *dup_block = nir_start_block(dup_impl);
+   nir_foreach_block(block, impl) {
+      ASSERT_EQ(exec_list_length(&block->instr_list),
+                exec_list_length(&dup_block->instr_list));
+
+      nir_instr *dup_instr = nir_block_first_instr(dup_block);
+      nir_foreach_instr(instr, block) {
+         ASSERT_EQ(instr->type, dup_instr->type);
+         ASSERT_EQ(dup_instr->block, dup_block);
+
+         nir_ssa_def *def = nir_instr_ssa_def(instr);
+         nir_ssa_def *dup_def = nir_instr_ssa_def(dup_instr);
+         if (def) {
+            ASSERT_EQ(def->index, dup_def->index);
+            ASSERT_EQ(list_length(&def->uses), list_length(&dup_def->uses));
+            ASSERT_EQ(list_length(&def->if_uses),
+                      list_length(&dup_def->if_uses));
+
+            nir_foreach_use(use, dup_def) {
+               ASSERT_EQ(use->ssa, dup_def);
+               ASSERT_NE(use->parent_instr->block, (nir_block *)NULL);
+            }
+         }
+
+         dup_instr = nir_instr_next(dup_instr);
+      }
+
+      dup_block = nir_block_cf_tree_next(dup_block);
+   }
+}
+
+/* Deserialization timing of the large shader.  Disabled by default, run it
+ * with --gtest_also_run_disabled_tests.
+ */
+TEST_F(nir_serialize_large_test, DISABLED_deserialize_benchmark)
+{
+   const unsigned iterations = 64;
+   struct blob blob;
+
+   build_large_shader();
+   blob_init(&blob);
+   nir_serialize(&blob, b->shader, false);
+
+   int64_t elapsed = 0;
+   for (unsigned i = 0; i < iterations; i++) {
+      struct blob_reader reader;
+      blob_reader_init(&reader, blob.data, blob.size);
+
+      int64_t start = os_time_get_nano();
+      nir_shader *cloned = nir_deserialize(mem_ctx, &options, &reader);
+      elapsed += os_time_get_nano() - start;
+
+      ralloc_free(cloned);
+   }
+   blob_finish(&blob);
+
+   printf("deserialized %u SSA defs in %.3f ms\n",
+          nir_shader_get_entrypoint(b->shader)->ssa_alloc,
+          elapsed / 1e6 / iterations);
+}
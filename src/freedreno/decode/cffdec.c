@@ -950,6 +950,10 @@ dump_domain(uint32_t *dwords, uint32_t sizedwords, int level,
 static uint32_t bin_x1, bin_x2, bin_y1, bin_y2;
 static unsigned mode;
 static const char *render_mode;
+/* copy of render_mode restored from a checkpoint, render_mode otherwise
+ * points to static strings
+ */
+static char *checkpoint_render_mode;
 static enum {
 	MODE_BINNING = 0x1,
 	MODE_GMEM    = 0x2,
@@ -2775,3 +2779,182 @@ dump_commands(uint32_t *dwords, uint32_t sizedwords, int level)
 	if (dwords_left < 0)
 		printf("**** this ain't right!! dwords_left=%d\n", dwords_left);
 }
+
+/*
+ * Checkpoints, for cffdump's index.  The register and draw state that
+ * carries over from one submit to the next is written as a delta against
+ * the previous checkpoint, so reading checkpoints back in order rebuilds
+ * the state at any of them without decoding the cmdstream in between.
+ */
+
+#define REG_FLAG_WRITTEN   0x1
+#define REG_FLAG_REWRITTEN 0x2
+
+struct checkpoint_reg {
+	uint32_t regbase;
+	uint32_t val;
+	uint32_t lastval;
+	uint32_t flags;
+};
+
+static struct {
+	uint32_t vals[ARRAY_SIZE(type0_reg_vals)];
+	uint32_t lastvals[ARRAY_SIZE(type0_reg_vals)];
+	uint8_t flags[ARRAY_SIZE(type0_reg_vals)];
+} *checkpoint;
+
+static uint32_t
+reg_flags(uint32_t regbase)
+{
+	return (reg_written(regbase) ? REG_FLAG_WRITTEN : 0) |
+		(reg_rewritten(regbase) ? REG_FLAG_REWRITTEN : 0);
+}
+
+static void
+set_reg_flags(uint32_t regbase, uint32_t flags)
+{
+	uint8_t bit = 1 << (regbase % 8);
+
+	type0_reg_written[regbase/8] &= ~bit;
+	type0_reg_rewritten[regbase/8] &= ~bit;
+	if (flags & REG_FLAG_WRITTEN)
+		type0_reg_written[regbase/8] |= bit;
+	if (flags & REG_FLAG_REWRITTEN)
+		type0_reg_rewritten[regbase/8] |= bit;
+}
+
+/* The scalar state, written as is after the register delta: */
+struct checkpoint_scalars {
+	int draw_count;
+	int draws[ARRAY_SIZE(draws)];
+	int vertices;
+	unsigned mode;
+	unsigned enable_mask;
+	uint32_t bin_x1, bin_x2, bin_y1, bin_y2;
+	bool skip_ib2_enable_global;
+	bool skip_ib2_enable_local;
+	int draw_mode;
+	bool needs_wfi;
+	struct draw_state state[ARRAY_SIZE(state)];
+	char render_mode[32];
+};
+
+int
+cffdec_draw_count(void)
+{
+	return draw_count;
+}
+
+bool
+cffdec_write_checkpoint(FILE *f)
+{
+	struct checkpoint_scalars scalars = {
+		.draw_count = draw_count,
+		.vertices = vertices,
+		.mode = mode,
+		.enable_mask = enable_mask,
+		.bin_x1 = bin_x1, .bin_x2 = bin_x2,
+		.bin_y1 = bin_y1, .bin_y2 = bin_y2,
+		.skip_ib2_enable_global = skip_ib2_enable_global,
+		.skip_ib2_enable_local = skip_ib2_enable_local,
+		.draw_mode = draw_mode,
+		.needs_wfi = needs_wfi,
+	};
+	uint32_t count = 0;
+
+	if (!checkpoint) {
+		checkpoint = calloc(1, sizeof(*checkpoint));
+		if (!checkpoint)
+			return false;
+	}
+
+	for (uint32_t i = 0; i < regcnt(); i++) {
+		if (checkpoint->vals[i] != type0_reg_vals[i] ||
+				checkpoint->lastvals[i] != lastvals[i] ||
+				checkpoint->flags[i] != reg_flags(i))
+			count++;
+	}
+
+	if (fwrite(&count, sizeof(count), 1, f) != 1)
+		return false;
+
+	for (uint32_t i = 0; i < regcnt(); i++) {
+		struct checkpoint_reg reg = {
+			.regbase = i,
+			.val = type0_reg_vals[i],
+			.lastval = lastvals[i],
+			.flags = reg_flags(i),
+		};
+
+		if (checkpoint->vals[i] == reg.val &&
+				checkpoint->lastvals[i] == reg.lastval &&
+				checkpoint->flags[i] == reg.flags)
+			continue;
+
+		if (fwrite(&reg, sizeof(reg), 1, f) != 1)
+			return false;
+
+		checkpoint->vals[i] = reg.val;
+		checkpoint->lastvals[i] = reg.lastval;
+		checkpoint->flags[i] = reg.flags;
+	}
+
+	memcpy(scalars.draws, draws, sizeof(draws));
+	memcpy(scalars.state, state, sizeof(state));
+	if (render_mode)
+		strncpy(scalars.render_mode, render_mode,
+				sizeof(scalars.render_mode) - 1);
+
+	return fwrite(&scalars, sizeof(scalars), 1, f) == 1;
+}
+
+bool
+cffdec_read_checkpoint(FILE *f)
+{
+	struct checkpoint_scalars scalars;
+	uint32_t count;
+
+	if (fread(&count, sizeof(count), 1, f) != 1)
+		return false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		struct checkpoint_reg reg;
+
+		if (fread(&reg, sizeof(reg), 1, f) != 1)
+			return false;
+		if (reg.regbase >= ARRAY_SIZE(type0_reg_vals))
+			return false;
+
+		type0_reg_vals[reg.regbase] = reg.val;
+		lastvals[reg.regbase] = reg.lastval;
+		set_reg_flags(reg.regbase, reg.flags);
+	}
+
+	if (fread(&scalars, sizeof(scalars), 1, f) != 1)
+		return false;
+
+	draw_count = scalars.draw_count;
+	memcpy(draws, scalars.draws, sizeof(draws));
+	vertices = scalars.vertices;
+	mode = scalars.mode;
+	enable_mask = scalars.enable_mask;
+	bin_x1 = scalars.bin_x1;
+	bin_x2 = scalars.bin_x2;
+	bin_y1 = scalars.bin_y1;
+	bin_y2 = scalars.bin_y2;
+	skip_ib2_enable_global = scalars.skip_ib2_enable_global;
+	skip_ib2_enable_local = scalars.skip_ib2_enable_local;
+	draw_mode = scalars.draw_mode;
+	needs_wfi = scalars.needs_wfi;
+	memcpy(state, scalars.state, sizeof(state));
+
+	free(checkpoint_render_mode);
+	checkpoint_render_mode = NULL;
+
+	scalars.render_mode[sizeof(scalars.render_mode) - 1] = '\0';
+	if (scalars.render_mode[0])
+		checkpoint_render_mode = strdup(scalars.render_mode);
+	render_mode = checkpoint_render_mode;
+
+	return true;
+}
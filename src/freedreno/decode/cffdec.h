@@ -25,6 +25,7 @@
 #define __CFFDEC_H__
 
 #include <stdbool.h>
+#include <stdio.h>
 
 enum query_mode {
 	/* default mode, dump all queried regs on each draw: */
@@ -87,6 +88,10 @@ void cffdec_init(const struct cffdec_options *options);
 void dump_register_val(uint32_t regbase, uint32_t dword, int level);
 void dump_commands(uint32_t *dwords, uint32_t sizedwords, int level);
 
+int cffdec_draw_count(void);
+bool cffdec_write_checkpoint(FILE *f);
+bool cffdec_read_checkpoint(FILE *f);
+
 /*
  * Helpers for packet parsing:
  */
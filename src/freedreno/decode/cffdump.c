@@ -58,6 +58,7 @@ static bool is_blob = false;
 static int show_comp = false;
 static int interactive;
 static int vertices;
+static int build_index;
 
 static int handle_file(const char *filename, int start, int end, int draw);
 
@@ -103,6 +104,10 @@ static void print_usage(const char *name)
 			"\t                   which can be useful when looking at state that does\n"
 			"\t                   not change per tile\n"
 			"\t--not-once       - decode cmdstream for each IB (default)\n"
+			"\t--index          - write an index of the file to FILE.idx while\n"
+			"\t                   decoding it; later runs with --start, --frame or\n"
+			"\t                   --draw use it to jump to the first submit of\n"
+			"\t                   interest instead of decoding everything before it\n"
 			"\t-h, --help       - show this message\n"
 			, name);
 	exit(2);
@@ -123,6 +128,7 @@ static const struct option opts[] = {
 	{ "query-compare",   no_argument, &options.query_compare, 1 },
 	{ "once",            no_argument, &options.once,          1 },
 	{ "not-once",        no_argument, &options.once,          0 },
+	{ "index",           no_argument, &build_index,           1 },
 
 	/* Long opts with short alias: */
 	{ "verbose",   no_argument,       0, 'v' },
@@ -193,6 +199,11 @@ int main(int argc, char **argv)
 		}
 	}
 
+	if (build_index && (start != 0 || end != 0x7ffffff || draw != -1)) {
+		fprintf(stderr, "--index needs to decode the whole file!\n");
+		print_usage(argv[0]);
+	}
+
 	disasm_a2xx_set_debug(debug);
 	disasm_a3xx_set_debug(debug);
 
@@ -234,6 +245,220 @@ static void parse_addr(uint32_t *buf, int sz, unsigned int *len, uint64_t *gpuad
 		*gpuaddr |= ((uint64_t)(buf[2])) << 32;
 }
 
+/*
+ * Index sidecar file, FILE.idx: a header followed by one entry per submit.
+ * Each entry records where the sections belonging to the submit start in
+ * the capture, along with a checkpoint of the decoder state at that point
+ * (see cffdec_write_checkpoint()).
+ */
+
+#define INDEX_MAGIC "cffidx2"
+
+struct index_header {
+	char magic[8];
+	uint64_t capture_size;
+	int64_t capture_mtime;
+	uint32_t gpu_id;
+	uint32_t pad;
+};
+
+struct index_entry {
+	uint64_t offset;
+	uint32_t submit;
+	int32_t draw_count;
+	uint32_t skip;
+	uint32_t checkpoint_size;
+};
+
+static char *
+index_filename(const char *filename)
+{
+	char *name;
+	if (asprintf(&name, "%s.idx", filename) < 0)
+		return NULL;
+	return name;
+}
+
+static bool
+index_header_init(struct index_header *hdr, const char *filename)
+{
+	struct stat st;
+
+	if (stat(filename, &st))
+		return false;
+
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	hdr->capture_size = st.st_size;
+	hdr->capture_mtime = st.st_mtime;
+	hdr->gpu_id = options.gpu_id;
+
+	return true;
+}
+
+static FILE *
+index_create(const char *filename)
+{
+	struct index_header hdr;
+	char *name;
+	FILE *f;
+
+	if (!index_header_init(&hdr, filename))
+		return NULL;
+
+	name = index_filename(filename);
+	if (!name)
+		return NULL;
+
+	f = fopen(name, "wb");
+	if (!f)
+		fprintf(stderr, "could not create index: %s\n", name);
+	free(name);
+
+	/* Rewritten with the actual gpu_id by index_finish(): */
+	if (f && fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+		fclose(f);
+		f = NULL;
+	}
+
+	return f;
+}
+
+static bool
+index_add(FILE *f, int submit, uint64_t offset, bool skip)
+{
+	struct index_entry entry = {
+		.submit = submit,
+		.offset = offset,
+		.draw_count = cffdec_draw_count(),
+		.skip = skip,
+	};
+	long pos = ftell(f);
+
+	if (fwrite(&entry, sizeof(entry), 1, f) != 1 ||
+			!cffdec_write_checkpoint(f))
+		return false;
+
+	/* Patch in the size, so readers can step over checkpoints: */
+	long end = ftell(f);
+	entry.checkpoint_size = end - pos - sizeof(entry);
+
+	return !fseek(f, pos, SEEK_SET) &&
+		fwrite(&entry, sizeof(entry), 1, f) == 1 &&
+		!fseek(f, end, SEEK_SET);
+}
+
+static void
+index_finish(FILE *f, const char *filename)
+{
+	struct index_header hdr;
+
+	if (index_header_init(&hdr, filename) && !fseek(f, 0, SEEK_SET))
+		fwrite(&hdr, sizeof(hdr), 1, f);
+
+	fclose(f);
+}
+
+/*
+ * Restore the decoder state for the first submit to decode, and skip the
+ * io to it.  Returns false if there is no usable index, in which case the
+ * file is decoded from the start as usual.
+ */
+static bool
+index_seek(const char *filename, struct io *io, int *start, int *end, int draw,
+		int *submit, bool *skip)
+{
+	struct index_header hdr, expected;
+	struct index_entry entry, target;
+	bool found = false;
+	long entries;
+	char *name;
+	FILE *f;
+
+	if (options.script || options.once || options.query_compare)
+		return false;
+
+	if (!index_header_init(&expected, filename))
+		return false;
+
+	name = index_filename(filename);
+	if (!name)
+		return false;
+	f = fopen(name, "rb");
+	free(name);
+	if (!f)
+		return false;
+
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+			memcmp(hdr.magic, expected.magic, sizeof(hdr.magic)) ||
+			hdr.capture_size != expected.capture_size ||
+			hdr.capture_mtime != expected.capture_mtime) {
+		fprintf(stderr, "ignoring stale index for %s\n", filename);
+		fclose(f);
+		return false;
+	}
+
+	/* Find the first submit to decode.  For a draw it is the one where
+	 * the draw count reaches the draw, since anything after the previous
+	 * draw is shown as part of it:
+	 */
+	entries = ftell(f);
+	while (fread(&entry, sizeof(entry), 1, f) == 1) {
+		if (draw >= 0) {
+			if (entry.draw_count > draw) {
+				/* Nothing past this submit is going to be shown: */
+				*end = min(*end, (int)entry.submit);
+				break;
+			}
+			if (!found || entry.draw_count < draw)
+				target = entry;
+		} else {
+			if ((int)entry.submit > *start)
+				break;
+			target = entry;
+		}
+		found = true;
+
+		if (fseek(f, entry.checkpoint_size, SEEK_CUR))
+			break;
+	}
+
+	if (!found) {
+		fclose(f);
+		return false;
+	}
+
+	/* And replay the state up to it: */
+	options.gpu_id = hdr.gpu_id;
+	cffdec_init(&options);
+
+	fseek(f, entries, SEEK_SET);
+	while (fread(&entry, sizeof(entry), 1, f) == 1) {
+		if (!cffdec_read_checkpoint(f)) {
+			fprintf(stderr, "corrupt index for %s\n", filename);
+			found = false;
+			break;
+		}
+		if (entry.submit == target.submit)
+			break;
+	}
+
+	fclose(f);
+
+	if (!found || io_skip(io, target.offset)) {
+		/* The state might be half restored, start over: */
+		cffdec_init(&options);
+		return false;
+	}
+
+	*submit = target.submit;
+	*skip = target.skip;
+	if (draw >= 0 && *start < (int)target.submit)
+		*start = target.submit;
+
+	return true;
+}
+
 static int handle_file(const char *filename, int start, int end, int draw)
 {
 	enum rd_sect_type type = RD_NONE;
@@ -243,6 +468,10 @@ static int handle_file(const char *filename, int start, int end, int draw)
 	int sz, ret = 0;
 	bool needs_reset = false;
 	bool skip = false;
+	bool seeked = false;
+	FILE *index = NULL;
+	uint64_t submit_offset = 0;
+	bool submit_skip = false;
 
 	options.draw_filter = draw;
 
@@ -262,6 +491,14 @@ static int handle_file(const char *filename, int start, int end, int draw)
 		return -1;
 	}
 
+	if (build_index && strcmp(filename, "-")) {
+		index = index_create(filename);
+	} else if ((start > 0 || draw >= 0) && strcmp(filename, "-")) {
+		seeked = index_seek(filename, io, &start, &end, draw, &submit, &skip);
+		got_gpu_id = seeked;
+		submit_skip = skip;
+	}
+
 	struct {
 		unsigned int len;
 		uint64_t gpuaddr;
@@ -270,6 +507,10 @@ static int handle_file(const char *filename, int start, int end, int draw)
 	while (true) {
 		uint32_t arr[2];
 
+		/* With an index we know nothing else is going to be shown: */
+		if (seeked && submit > end)
+			goto end;
+
 		ret = io_readn(io, arr, 8);
 		if (ret <= 0)
 			goto end;
@@ -331,6 +572,11 @@ static int handle_file(const char *filename, int start, int end, int draw)
 			buf = NULL;
 			break;
 		case RD_CMDSTREAM_ADDR:
+			if (index && !index_add(index, submit, submit_offset, submit_skip)) {
+				fprintf(stderr, "could not write index\n");
+				fclose(index);
+				index = NULL;
+			}
 			if ((start <= submit) && (submit <= end)) {
 				unsigned int sizedwords;
 				uint64_t gpuaddr;
@@ -347,6 +593,8 @@ static int handle_file(const char *filename, int start, int end, int draw)
 			}
 			needs_reset = true;
 			submit++;
+			submit_offset = io_offset(io);
+			submit_skip = skip;
 			break;
 		case RD_GPU_ID:
 			if (!got_gpu_id) {
@@ -364,6 +612,9 @@ static int handle_file(const char *filename, int start, int end, int draw)
 end:
 	script_end_cmdstream();
 
+	if (index)
+		index_finish(index, filename);
+
 	io_close(io);
 	fflush(stdout);
 
@@ -28,6 +28,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -39,7 +40,16 @@
 struct io {
 	struct archive *a;
 	struct archive_entry *entry;
-	unsigned offset;
+	uint64_t offset;
+
+	/* For plain uncompressed files which can be seeked, data is read
+	 * directly from fd rather than through libarchive.  Otherwise -1.
+	 */
+	int fd;
+	/* file position of offset 0 */
+	off_t base;
+	/* fd opened by io_open() to close in io_close(), or -1 */
+	int close_fd;
 };
 
 static void io_error(struct io *io)
@@ -56,6 +66,8 @@ static struct io * io_new(void)
 	if (!io)
 		return NULL;
 
+	io->fd = -1;
+	io->close_fd = -1;
 	io->a = archive_read_new();
 	ret = archive_read_support_filter_gzip(io->a);
 	if (ret != ARCHIVE_OK) {
@@ -84,15 +96,43 @@ static struct io * io_new(void)
 	return io;
 }
 
-struct io * io_open(const char *filename)
+/* If libarchive found neither compression nor an archive format, and the
+ * file can be seeked, bypass libarchive so that io_skip() can lseek().
+ */
+static void io_check_plain(struct io *io, int fd, off_t base)
+{
+	if (base < 0)
+		return;
+
+	if (archive_filter_code(io->a, 0) != ARCHIVE_FILTER_NONE ||
+			archive_format(io->a) != ARCHIVE_FORMAT_RAW)
+		return;
+
+	/* libarchive has already read ahead, rewind to the start */
+	if (lseek(fd, base, SEEK_SET) != base)
+		return;
+
+	io->fd = fd;
+	io->base = base;
+}
+
+static struct io * io_open_common(int fd, int close_fd)
 {
 	struct io *io = io_new();
+	off_t base;
 	int ret;
 
-	if (!io)
+	if (!io) {
+		if (close_fd)
+			close(fd);
 		return NULL;
+	}
+
+	/* fails for pipes */
+	base = lseek(fd, 0, SEEK_CUR);
+	io->close_fd = close_fd ? fd : -1;
 
-	ret = archive_read_open_filename(io->a, filename, 10240);
+	ret = archive_read_open_fd(io->a, fd, 10240);
 	if (ret != ARCHIVE_OK) {
 		io_error(io);
 		return NULL;
@@ -104,39 +144,37 @@ struct io * io_open(const char *filename)
 		return NULL;
 	}
 
+	io_check_plain(io, fd, base);
+
 	return io;
 }
 
-struct io * io_openfd(int fd)
+struct io * io_open(const char *filename)
 {
-	struct io *io = io_new();
-	int ret;
+	int fd = open(filename, O_RDONLY);
 
-	if (!io)
-		return NULL;
-
-	ret = archive_read_open_fd(io->a, fd, 10240);
-	if (ret != ARCHIVE_OK) {
-		io_error(io);
+	if (fd < 0) {
+		perror(filename);
 		return NULL;
 	}
 
-	ret = archive_read_next_header(io->a, &io->entry);
-	if (ret != ARCHIVE_OK) {
-		io_error(io);
-		return NULL;
-	}
+	return io_open_common(fd, 1);
+}
 
-	return io;
+struct io * io_openfd(int fd)
+{
+	return io_open_common(fd, 0);
 }
 
 void io_close(struct io *io)
 {
 	archive_read_free(io->a);
+	if (io->close_fd >= 0)
+		close(io->close_fd);
 	free(io);
 }
 
-unsigned io_offset(struct io *io)
+uint64_t io_offset(struct io *io)
 {
 	return io->offset;
 }
@@ -147,10 +185,19 @@ int io_readn(struct io *io, void *buf, int nbytes)
 	char *ptr = buf;
 	int ret = 0;
 	while (nbytes > 0) {
-		int n = archive_read_data(io->a, ptr, nbytes);
-		if (n < 0) {
-			fprintf(stderr, "%s\n", archive_error_string(io->a));
-			return n;
+		int n;
+		if (io->fd >= 0) {
+			n = read(io->fd, ptr, nbytes);
+			if (n < 0) {
+				perror("read");
+				return n;
+			}
+		} else {
+			n = archive_read_data(io->a, ptr, nbytes);
+			if (n < 0) {
+				fprintf(stderr, "%s\n", archive_error_string(io->a));
+				return n;
+			}
 		}
 		if (n == 0)
 			break;
@@ -161,3 +208,33 @@ int io_readn(struct io *io, void *buf, int nbytes)
 	}
 	return ret;
 }
+
+/* Skip ahead to the given offset.  Plain files are seeked, compressed
+ * streams and pipes are read and the data thrown away, which is still
+ * much cheaper than decoding what is skipped.
+ */
+int io_skip(struct io *io, uint64_t offset)
+{
+	char buf[65536];
+
+	if (io->offset >= offset)
+		return 0;
+
+	if (io->fd >= 0) {
+		off_t pos = io->base + offset;
+		if (lseek(io->fd, pos, SEEK_SET) != pos)
+			return -1;
+		io->offset = offset;
+		return 0;
+	}
+
+	while (io->offset < offset) {
+		uint64_t n = offset - io->offset;
+		if (n > sizeof(buf))
+			n = sizeof(buf);
+		int ret = io_readn(io, buf, n);
+		if (ret <= 0)
+			return -1;
+	}
+	return 0;
+}
@@ -29,6 +29,8 @@
 #ifndef IO_H_
 #define IO_H_
 
+#include <stdint.h>
+
 /* Simple API to abstract reading from file which might be compressed.
  * Maybe someday I'll add writing..
  */
@@ -38,8 +40,9 @@ struct io;
 struct io * io_open(const char *filename);
 struct io * io_openfd(int fd);
 void io_close(struct io *io);
-unsigned io_offset(struct io *io);
+uint64_t io_offset(struct io *io);
 int io_readn(struct io *io, void *buf, int nbytes);
+int io_skip(struct io *io, uint64_t offset);
 
 
 static inline int
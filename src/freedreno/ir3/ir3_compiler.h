@@ -141,6 +141,7 @@ enum ir3_shader_debug {
 	IR3_DBG_NOUBOOPT   = BITFIELD_BIT(9),
 	IR3_DBG_NOFP16     = BITFIELD_BIT(10),
 	IR3_DBG_NOCACHE    = BITFIELD_BIT(11),
+	IR3_DBG_GRAPHRA    = BITFIELD_BIT(12),
 
 	/* DEBUG-only options: */
 	IR3_DBG_SCHEDMSGS  = BITFIELD_BIT(20),
@@ -1023,6 +1023,31 @@ ra_calc_max_live_values(struct ir3_ra_ctx *ctx)
 	return max;
 }
 
+/* Sort the names by the start of their live range.  Since ip's are dense
+ * a counting sort does it in linear time:
+ */
+static void
+ra_sort_by_def(struct ir3_ra_ctx *ctx)
+{
+	unsigned max_def = 0;
+
+	for (unsigned i = 0; i < ctx->alloc_count; i++)
+		max_def = MAX2(max_def, ctx->def[i]);
+
+	unsigned *first = rzalloc_array(ctx->g, unsigned, max_def + 2);
+
+	for (unsigned i = 0; i < ctx->alloc_count; i++)
+		first[ctx->def[i] + 1]++;
+	for (unsigned d = 0; d <= max_def; d++)
+		first[d + 1] += first[d];
+
+	ctx->order = ralloc_array(ctx->g, unsigned, ctx->alloc_count);
+	for (unsigned i = 0; i < ctx->alloc_count; i++)
+		ctx->order[first[ctx->def[i]]++] = i;
+
+	ralloc_free(first);
+}
+
 static void
 ra_add_interference(struct ir3_ra_ctx *ctx)
 {
@@ -1109,14 +1134,42 @@ ra_add_interference(struct ir3_ra_ctx *ctx)
 		ra_set_register_target(ctx, max);
 	}
 
-	for (unsigned i = 0; i < ctx->alloc_count; i++) {
-		for (unsigned j = 0; j < ctx->alloc_count; j++) {
+	ra_sort_by_def(ctx);
+
+	/* Since live ranges are intervals, a name can only interfere with
+	 * the names that are still live where it is defined.  So walk the
+	 * names in def order, keeping a list of the ones still live, rather
+	 * than checking every pair:
+	 */
+	unsigned *live = ralloc_array(ctx->g, unsigned, ctx->alloc_count);
+	unsigned nlive = 0;
+
+	for (unsigned k = 0; k < ctx->alloc_count; k++) {
+		unsigned i = ctx->order[k];
+		unsigned n = 0;
+
+		for (unsigned l = 0; l < nlive; l++) {
+			unsigned j = live[l];
+
+			/* dead before i, and so before anything after it too: */
+			if (ctx->use[j] <= ctx->def[i])
+				continue;
+
+			live[n++] = j;
+
 			if (intersects(ctx->def[i], ctx->use[i],
 					ctx->def[j], ctx->use[j])) {
 				ra_add_node_interference(ctx->g, i, j);
 			}
 		}
+
+		if (ctx->use[i] > ctx->def[i])
+			live[n++] = i;
+
+		nlive = n;
 	}
+
+	ralloc_free(live);
 }
 
 /* NOTE: instr could be NULL for IR3_REG_ARRAY case, for the first
@@ -1473,8 +1526,24 @@ ra_precolor_assigned(struct ir3_ra_ctx *ctx)
 static int
 ra_alloc(struct ir3_ra_ctx *ctx)
 {
-	if (!ra_allocate(ctx->g))
-		return -1;
+	unsigned start_search_reg = ctx->start_search_reg;
+	unsigned max_target = ctx->max_target;
+	bool allocated = false;
+
+	/* The interference graph of intervals is chordal, so coloring the
+	 * names in def order succeeds in most cases, without the (superlinear)
+	 * simplify step of the graph coloring.  But vecN classes can still
+	 * fragment the register file, in which case fall back to it:
+	 */
+	if (!(ir3_shader_debug & IR3_DBG_GRAPHRA))
+		allocated = ra_allocate_in_order(ctx->g, ctx->order);
+
+	if (!allocated) {
+		ctx->start_search_reg = start_search_reg;
+		ctx->max_target = max_target;
+		if (!ra_allocate(ctx->g))
+			return -1;
+	}
 
 	foreach_block (block, &ctx->ir->block_list) {
 		ra_block_alloc(ctx, block);
@@ -162,6 +162,7 @@ struct ir3_ra_ctx {
 	unsigned class_base[total_class_count + 1];
 	unsigned instr_cnt;
 	unsigned *def, *use;     /* def/use table */
+	unsigned *order;         /* names sorted by def */
 	struct ir3_ra_instr_data *instrd;
 
 	/* Mapping vreg name back to instruction, used select reg callback: */
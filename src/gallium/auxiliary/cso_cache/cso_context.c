@@ -128,6 +128,14 @@ struct cso_context {
    unsigned sample_mask, sample_mask_saved;
    unsigned min_samples, min_samples_saved;
    struct pipe_stencil_ref stencil_ref, stencil_ref_saved;
+
+   /** Cache entries of the last states set through cso_set_*, compared
+    * against new templates before hashing them. Cleared when the entry is
+    * deleted.
+    */
+   struct cso_blend *last_blend;
+   struct cso_depth_stencil_alpha *last_depth_stencil;
+   struct cso_rasterizer *last_rasterizer;
 };
 
 struct pipe_context *cso_get_pipe_context(struct cso_context *cso)
@@ -142,6 +150,8 @@ static boolean delete_blend_state(struct cso_context *ctx, void *state)
    if (ctx->blend == cso->data)
       return FALSE;
 
+   if (ctx->last_blend == cso)
+      ctx->last_blend = NULL;
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -156,6 +166,8 @@ static boolean delete_depth_stencil_state(struct cso_context *ctx, void *state)
    if (ctx->depth_stencil == cso->data)
       return FALSE;
 
+   if (ctx->last_depth_stencil == cso)
+      ctx->last_depth_stencil = NULL;
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -178,6 +190,8 @@ static boolean delete_rasterizer_state(struct cso_context *ctx, void *state)
 
    if (ctx->rasterizer == cso->data)
       return FALSE;
+   if (ctx->last_rasterizer == cso)
+      ctx->last_rasterizer = NULL;
    if (cso->delete_state)
       cso->delete_state(cso->context, cso->data);
    FREE(state);
@@ -220,6 +234,25 @@ static inline boolean delete_cso(struct cso_context *ctx,
    return FALSE;
 }
 
+/**
+ * Remove the entry holding \p data from the hash.  Several entries may
+ * share the key, so look for the exact one rather than the first one.
+ */
+static bool
+take_exact_node(struct cso_hash *hash, unsigned key, void *data)
+{
+   struct cso_hash_iter iter = cso_hash_find(hash, key);
+
+   while (!cso_hash_iter_is_null(iter)) {
+      if (cso_hash_iter_data(iter) == data) {
+         cso_hash_erase(hash, iter);
+         return true;
+      }
+      iter = cso_hash_find_next(iter);
+   }
+   return false;
+}
+
 static inline void
 sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
               int max_size, void *user_data)
@@ -243,17 +276,21 @@ sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
    if (type == CSO_SAMPLER) {
       int i, j;
 
-      samplers_to_restore = MALLOC(PIPE_SHADER_TYPES * PIPE_MAX_SAMPLERS *
+      samplers_to_restore = MALLOC((PIPE_SHADER_TYPES + 1) *
+                                   PIPE_MAX_SAMPLERS *
                                    sizeof(*samplers_to_restore));
 
-      /* Temporarily remove currently bound sampler states from the hash
-       * table, to prevent them from being deleted
+      /* Temporarily remove currently bound and saved sampler states from
+       * the hash table, to prevent them from being deleted
        */
-      for (i = 0; i < PIPE_SHADER_TYPES; i++) {
+      for (i = 0; i <= PIPE_SHADER_TYPES; i++) {
+         struct sampler_info *info = i < PIPE_SHADER_TYPES ?
+            &ctx->samplers[i] : &ctx->fragment_samplers_saved;
+
          for (j = 0; j < PIPE_MAX_SAMPLERS; j++) {
-            struct cso_sampler *sampler = ctx->samplers[i].cso_samplers[j];
+            struct cso_sampler *sampler = info->cso_samplers[j];
 
-            if (sampler && cso_hash_take(hash, sampler->hash_key))
+            if (sampler && take_exact_node(hash, sampler->hash_key, sampler))
                samplers_to_restore[to_restore++] = sampler;
          }
       }
@@ -467,17 +504,24 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
 {
    unsigned key_size, hash_key;
    struct cso_hash_iter iter;
+   struct cso_blend *cso;
    void *handle;
 
    key_size = templ->independent_blend_enable ?
       sizeof(struct pipe_blend_state) :
       (char *)&(templ->rt[1]) - (char *)templ;
+
+   /* Setting the same state again is common, skip the lookup for it */
+   if (ctx->last_blend && ctx->last_blend->data == ctx->blend &&
+       !memcmp(&ctx->last_blend->state, templ, key_size))
+      return PIPE_OK;
+
    hash_key = cso_construct_key((void*)templ, key_size);
    iter = cso_find_state_template(ctx->cache, hash_key, CSO_BLEND,
                                   (void*)templ, key_size);
 
    if (cso_hash_iter_is_null(iter)) {
-      struct cso_blend *cso = MALLOC(sizeof(struct cso_blend));
+      cso = MALLOC(sizeof(struct cso_blend));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -492,13 +536,14 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
    }
    else {
-      handle = ((struct cso_blend *)cso_hash_iter_data(iter))->data;
+      cso = (struct cso_blend *)cso_hash_iter_data(iter);
    }
 
+   handle = cso->data;
+   ctx->last_blend = cso;
+
    if (ctx->blend != handle) {
       ctx->blend = handle;
       ctx->pipe->bind_blend_state(ctx->pipe, handle);
@@ -530,16 +575,24 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
                             const struct pipe_depth_stencil_alpha_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_depth_stencil_alpha_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key,
-                                                       CSO_DEPTH_STENCIL_ALPHA,
-                                                       (void*)templ, key_size);
+   unsigned hash_key;
+   struct cso_hash_iter iter;
+   struct cso_depth_stencil_alpha *cso;
    void *handle;
 
+   /* Setting the same state again is common, skip the lookup for it */
+   if (ctx->last_depth_stencil &&
+       ctx->last_depth_stencil->data == ctx->depth_stencil &&
+       !memcmp(&ctx->last_depth_stencil->state, templ, key_size))
+      return PIPE_OK;
+
+   hash_key = cso_construct_key((void*)templ, key_size);
+   iter = cso_find_state_template(ctx->cache, hash_key,
+                                  CSO_DEPTH_STENCIL_ALPHA,
+                                  (void*)templ, key_size);
+
    if (cso_hash_iter_is_null(iter)) {
-      struct cso_depth_stencil_alpha *cso =
-         MALLOC(sizeof(struct cso_depth_stencil_alpha));
+      cso = MALLOC(sizeof(struct cso_depth_stencil_alpha));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -556,14 +609,14 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
    }
    else {
-      handle = ((struct cso_depth_stencil_alpha *)
-                cso_hash_iter_data(iter))->data;
+      cso = (struct cso_depth_stencil_alpha *)cso_hash_iter_data(iter);
    }
 
+   handle = cso->data;
+   ctx->last_depth_stencil = cso;
+
    if (ctx->depth_stencil != handle) {
       ctx->depth_stencil = handle;
       ctx->pipe->bind_depth_stencil_alpha_state(ctx->pipe, handle);
@@ -595,11 +648,9 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
                                    const struct pipe_rasterizer_state *templ)
 {
    unsigned key_size = sizeof(struct pipe_rasterizer_state);
-   unsigned hash_key = cso_construct_key((void*)templ, key_size);
-   struct cso_hash_iter iter = cso_find_state_template(ctx->cache,
-                                                       hash_key,
-                                                       CSO_RASTERIZER,
-                                                       (void*)templ, key_size);
+   unsigned hash_key;
+   struct cso_hash_iter iter;
+   struct cso_rasterizer *cso;
    void *handle = NULL;
 
    /* We can't have both point_quad_rasterization (sprites) and point_smooth
@@ -607,8 +658,17 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
     */
    assert(!(templ->point_quad_rasterization && templ->point_smooth));
 
+   /* Setting the same state again is common, skip the lookup for it */
+   if (ctx->last_rasterizer && ctx->last_rasterizer->data == ctx->rasterizer &&
+       !memcmp(&ctx->last_rasterizer->state, templ, key_size))
+      return PIPE_OK;
+
+   hash_key = cso_construct_key((void*)templ, key_size);
+   iter = cso_find_state_template(ctx->cache, hash_key, CSO_RASTERIZER,
+                                  (void*)templ, key_size);
+
    if (cso_hash_iter_is_null(iter)) {
-      struct cso_rasterizer *cso = MALLOC(sizeof(struct cso_rasterizer));
+      cso = MALLOC(sizeof(struct cso_rasterizer));
       if (!cso)
          return PIPE_ERROR_OUT_OF_MEMORY;
 
@@ -623,13 +683,14 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
          FREE(cso);
          return PIPE_ERROR_OUT_OF_MEMORY;
       }
-
-      handle = cso->data;
    }
    else {
-      handle = ((struct cso_rasterizer *)cso_hash_iter_data(iter))->data;
+      cso = (struct cso_rasterizer *)cso_hash_iter_data(iter);
    }
 
+   handle = cso->data;
+   ctx->last_rasterizer = cso;
+
    if (ctx->rasterizer != handle) {
       ctx->rasterizer = handle;
       ctx->pipe->bind_rasterizer_state(ctx->pipe, handle);
@@ -1236,12 +1297,24 @@ cso_single_sampler(struct cso_context *ctx, enum pipe_shader_type shader_stage,
 {
    if (templ) {
       unsigned key_size = sizeof(struct pipe_sampler_state);
-      unsigned hash_key = cso_construct_key((void*)templ, key_size);
-      struct cso_sampler *cso;
-      struct cso_hash_iter iter =
-         cso_find_state_template(ctx->cache,
-                                 hash_key, CSO_SAMPLER,
-                                 (void *) templ, key_size);
+      unsigned hash_key;
+      struct cso_sampler *cso = ctx->samplers[shader_stage].cso_samplers[idx];
+      struct cso_hash_iter iter;
+
+      /* Most samplers are set to what is already in their slot. The
+       * cso_sampler in a slot is never freed by cache eviction, whether
+       * it was set or restored there, because sanitize_hash() takes the
+       * current and the saved samplers out of the hash while evicting.
+       */
+      if (cso && !memcmp(&cso->state, templ, key_size)) {
+         ctx->samplers[shader_stage].samplers[idx] = cso->data;
+         ctx->max_sampler_seen = MAX2(ctx->max_sampler_seen, (int)idx);
+         return;
+      }
+
+      hash_key = cso_construct_key((void*)templ, key_size);
+      iter = cso_find_state_template(ctx->cache, hash_key, CSO_SAMPLER,
+                                     (void *) templ, key_size);
 
       if (cso_hash_iter_is_null(iter)) {
          cso = MALLOC(sizeof(struct cso_sampler));
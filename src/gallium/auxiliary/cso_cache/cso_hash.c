@@ -39,282 +39,179 @@
 #define MAX(a, b) ((a > b) ? (a) : (b))
 #endif
 
-static const int MinNumBits = 4;
+static const unsigned MinNumBits = 4;
 
-static const unsigned char prime_deltas[] = {
-   0,  0,  1,  3,  1,  5,  3,  3,  1,  9,  7,  5,  3,  9, 25,  3,
-   1, 21,  3, 21,  7, 15,  9,  5,  3, 29, 15,  0,  0,  0,  0,  0
-};
-
-static int primeForNumBits(int numBits)
+static inline bool
+cso_node_is_live(const struct cso_hash *hash, const struct cso_node *node)
 {
-   return (1 << numBits) + prime_deltas[numBits];
+   return node->value && node->value != (void *)hash;
 }
 
-/*
-    Returns the smallest integer n such that
-    primeForNumBits(n) >= hint.
-*/
-static int countBits(int hint)
+static bool cso_data_rehash(struct cso_hash *hash, unsigned numBits)
 {
-   int numBits = 0;
-   int bits = hint;
+   struct cso_node *oldNodes = hash->nodes;
+   unsigned oldNumNodes = hash->nodes ? 1u << hash->numBits : 0;
+   unsigned mask = (1u << numBits) - 1;
+   unsigned i;
 
-   while (bits > 1) {
-      bits >>= 1;
-      numBits++;
+   hash->nodes = CALLOC(1u << numBits, sizeof(struct cso_node));
+   if (!hash->nodes) {
+      hash->nodes = oldNodes;
+      return false;
    }
+   hash->numBits = numBits;
+   hash->deleted = 0;
 
-   if (numBits >= (int)sizeof(prime_deltas)) {
-      numBits = sizeof(prime_deltas) - 1;
-   } else if (primeForNumBits(numBits) < hint) {
-      ++numBits;
+   for (i = 0; i < oldNumNodes; ++i) {
+      if (cso_node_is_live(hash, &oldNodes[i])) {
+         unsigned j = cso_hash_bucket(hash, oldNodes[i].key);
+
+         while (hash->nodes[j].value)
+            j = (j + 1) & mask;
+         hash->nodes[j] = oldNodes[i];
+      }
    }
-   return numBits;
+   FREE(oldNodes);
+   return true;
 }
 
-static struct cso_node *
-cso_hash_create_node(struct cso_hash *hash,
-                     unsigned akey, void *avalue,
-                     struct cso_node **anextNode)
+static bool cso_data_might_grow(struct cso_hash *hash)
 {
-   struct cso_node *node = MALLOC(sizeof(struct cso_node));
+   unsigned numNodes = hash->nodes ? 1u << hash->numBits : 0;
+   unsigned numBits = MinNumBits;
 
-   if (!node)
-      return NULL;
+   /* Keep the load factor, tombstones included, at most 3/4 */
+   if ((hash->size + hash->deleted + 1) * 4 <= numNodes * 3)
+      return true;
 
-   node->key = akey;
-   node->value = avalue;
+   /* Rehashing drops the tombstones, and leaves the table at most half
+    * full.
+    */
+   while ((1u << numBits) < (hash->size + 1) * 2)
+      ++numBits;
 
-   node->next = *anextNode;
-   *anextNode = node;
-   ++hash->size;
-   return node;
+   if (cso_data_rehash(hash, numBits))
+      return true;
+
+   /* Without memory we can still fill the table until one slot is left */
+   return hash->nodes && hash->size + hash->deleted + 1 < numNodes;
 }
 
-static void cso_data_rehash(struct cso_hash *hash, int hint)
+static void cso_data_has_shrunk(struct cso_hash *hash)
 {
-   if (hint < 0) {
-      hint = countBits(-hint);
-      if (hint < MinNumBits)
-         hint = MinNumBits;
-      hash->userNumBits = (short)hint;
-      while (primeForNumBits(hint) < (hash->size >> 1))
-         ++hint;
-   } else if (hint < MinNumBits) {
-      hint = MinNumBits;
-   }
-
-   if (hash->numBits != hint) {
-      struct cso_node *e = (struct cso_node *)hash;
-      struct cso_node **oldBuckets = hash->buckets;
-      int oldNumBuckets = hash->numBuckets;
-      int  i = 0;
-
-      hash->numBits = (short)hint;
-      hash->numBuckets = primeForNumBits(hint);
-      hash->buckets = MALLOC(sizeof(struct cso_node*) * hash->numBuckets);
-      for (i = 0; i < hash->numBuckets; ++i)
-         hash->buckets[i] = e;
-
-      for (i = 0; i < oldNumBuckets; ++i) {
-         struct cso_node *firstNode = oldBuckets[i];
-         while (firstNode != e) {
-            unsigned h = firstNode->key;
-            struct cso_node *lastNode = firstNode;
-            struct cso_node *afterLastNode;
-            struct cso_node **beforeFirstNode;
-            
-            while (lastNode->next != e && lastNode->next->key == h)
-               lastNode = lastNode->next;
-
-            afterLastNode = lastNode->next;
-            beforeFirstNode = &hash->buckets[h % hash->numBuckets];
-            while (*beforeFirstNode != e)
-               beforeFirstNode = &(*beforeFirstNode)->next;
-            lastNode->next = *beforeFirstNode;
-            *beforeFirstNode = firstNode;
-            firstNode = afterLastNode;
-         }
-      }
-      FREE(oldBuckets);
+   if (hash->size <= ((1u << hash->numBits) >> 3) &&
+       hash->numBits > MinNumBits) {
+      unsigned max = MAX(hash->numBits - 2, MinNumBits);
+      cso_data_rehash(hash, max);
    }
 }
 
-static void cso_data_might_grow(struct cso_hash *hash)
+static struct cso_node *cso_data_next_live(struct cso_hash *hash,
+                                           unsigned i)
 {
-   if (hash->size >= hash->numBuckets)
-      cso_data_rehash(hash, hash->numBits + 1);
-}
+   unsigned numNodes = hash->nodes ? 1u << hash->numBits : 0;
 
-static void cso_data_has_shrunk(struct cso_hash *hash)
-{
-   if (hash->size <= (hash->numBuckets >> 3) &&
-       hash->numBits > hash->userNumBits) {
-      int max = MAX(hash->numBits-2, hash->userNumBits);
-      cso_data_rehash(hash,  max);
+   for (; i < numNodes; ++i) {
+      if (cso_node_is_live(hash, &hash->nodes[i]))
+         return &hash->nodes[i];
    }
+   return NULL;
 }
 
-static struct cso_node *cso_data_first_node(struct cso_hash *hash)
+static void cso_data_remove(struct cso_hash *hash, struct cso_node *node)
 {
-   struct cso_node *e = (struct cso_node *)hash;
-   struct cso_node **bucket = hash->buckets;
-   int n = hash->numBuckets;
-
-   while (n--) {
-      if (*bucket != e)
-         return *bucket;
-      ++bucket;
+   const unsigned mask = (1u << hash->numBits) - 1;
+
+   /* If the next slot is empty no probe sequence goes through this one
+    * and it can become empty too.
+    */
+   if (!hash->nodes[((node - hash->nodes) + 1) & mask].value) {
+      node->value = NULL;
+   } else {
+      node->value = (void *)hash;
+      ++hash->deleted;
    }
-   return e;
+   --hash->size;
 }
 
 struct cso_hash_iter cso_hash_insert(struct cso_hash *hash,
                                      unsigned key, void *data)
 {
-   cso_data_might_grow(hash);
+   struct cso_hash_iter iter = {hash, NULL};
+   unsigned mask, i;
 
-   struct cso_node **nextNode = cso_hash_find_node(hash, key);
-   struct cso_node *node = cso_hash_create_node(hash, key, data, nextNode);
-   if (!node) {
-      struct cso_hash_iter null_iter = {hash, 0};
-      return null_iter;
-   }
+   assert(data && data != (void *)hash);
+
+   if (!cso_data_might_grow(hash))
+      return iter;
+
+   /* Take the first empty slot or tombstone along the probe sequence */
+   mask = (1u << hash->numBits) - 1;
+   i = cso_hash_bucket(hash, key);
+   while (cso_node_is_live(hash, &hash->nodes[i]))
+      i = (i + 1) & mask;
 
-   struct cso_hash_iter iter = {hash, node};
+   if (hash->nodes[i].value)
+      --hash->deleted;
+   hash->nodes[i].key = key;
+   hash->nodes[i].value = data;
+   ++hash->size;
+
+   iter.node = &hash->nodes[i];
    return iter;
 }
 
 void cso_hash_init(struct cso_hash *hash)
 {
-   hash->fakeNext = 0;
-   hash->buckets = 0;
+   hash->nodes = NULL;
    hash->size = 0;
-   hash->userNumBits = (short)MinNumBits;
+   hash->deleted = 0;
    hash->numBits = 0;
-   hash->numBuckets = 0;
-   hash->end = (struct cso_node*)hash;
 }
 
 void cso_hash_deinit(struct cso_hash *hash)
 {
-   struct cso_node *e_for_x = hash->end;
-   struct cso_node **bucket = hash->buckets;
-   int n = hash->numBuckets;
-
-   while (n--) {
-      struct cso_node *cur = *bucket++;
-      while (cur != e_for_x) {
-         struct cso_node *next = cur->next;
-         FREE(cur);
-         cur = next;
-      }
-   }
-   FREE(hash->buckets);
+   FREE(hash->nodes);
+   hash->nodes = NULL;
 }
 
 unsigned cso_hash_iter_key(struct cso_hash_iter iter)
 {
-   if (!iter.node || iter.hash->end == iter.node)
+   if (!iter.node)
       return 0;
    return iter.node->key;
 }
 
-struct cso_node *cso_hash_data_next(struct cso_node *node)
+struct cso_hash_iter cso_hash_iter_next(struct cso_hash_iter iter)
 {
-   union {
-      struct cso_node *next;
-      struct cso_node *e;
-      struct cso_hash *d;
-   } a;
-   int start;
-   struct cso_node **bucket;
-   int n;
-
-   a.next = node->next;
-   if (!a.next) {
-      debug_printf("iterating beyond the last element\n");
-      return NULL;
-   }
-   if (a.next->next)
-      return a.next;
-
-   start = (node->key % a.d->numBuckets) + 1;
-   bucket = a.d->buckets + start;
-   n = a.d->numBuckets - start;
-   while (n--) {
-      if (*bucket != a.e)
-         return *bucket;
-      ++bucket;
-   }
-   return a.e;
-}
+   struct cso_hash_iter next = {iter.hash, NULL};
 
-
-static struct cso_node *cso_hash_data_prev(struct cso_node *node)
-{
-   union {
-      struct cso_node *e;
-      struct cso_hash *d;
-   } a;
-   int start;
-   struct cso_node *sentinel;
-   struct cso_node **bucket;
-
-   a.e = node;
-   while (a.e->next)
-      a.e = a.e->next;
-
-   if (node == a.e)
-      start = a.d->numBuckets - 1;
-   else
-      start = node->key % a.d->numBuckets;
-
-   sentinel = node;
-   bucket = a.d->buckets + start;
-   while (start >= 0) {
-      if (*bucket != sentinel) {
-         struct cso_node *prev = *bucket;
-         while (prev->next != sentinel)
-            prev = prev->next;
-         return prev;
-      }
-
-      sentinel = a.e;
-      --bucket;
-      --start;
+   if (!iter.node) {
+      debug_printf("iterating beyond the last element\n");
+      return next;
    }
-   debug_printf("iterating backward beyond first element\n");
-   return a.e;
+   next.node = cso_data_next_live(iter.hash,
+                                  (iter.node - iter.hash->nodes) + 1);
+   return next;
 }
 
 void *cso_hash_take(struct cso_hash *hash, unsigned akey)
 {
-   struct cso_node **node = cso_hash_find_node(hash, akey);
-
-   if (*node != hash->end) {
-      void *t = (*node)->value;
-      struct cso_node *next = (*node)->next;
-      FREE(*node);
-      *node = next;
-      --hash->size;
-      cso_data_has_shrunk(hash);
-      return t;
-   }
-   return NULL;
-}
+   struct cso_hash_iter iter = cso_hash_find(hash, akey);
+   void *t;
 
-struct cso_hash_iter cso_hash_iter_prev(struct cso_hash_iter iter)
-{
-   struct cso_hash_iter prev = {iter.hash,
-                                cso_hash_data_prev(iter.node)};
-   return prev;
+   if (!iter.node)
+      return NULL;
+
+   t = iter.node->value;
+   cso_data_remove(hash, iter.node);
+   cso_data_has_shrunk(hash);
+   return t;
 }
 
 struct cso_hash_iter cso_hash_first_node(struct cso_hash *hash)
 {
-   struct cso_hash_iter iter = {hash, cso_data_first_node(hash)};
+   struct cso_hash_iter iter = {hash, cso_data_next_live(hash, 0)};
    return iter;
 }
 
@@ -325,25 +222,17 @@ int cso_hash_size(struct cso_hash *hash)
 
 struct cso_hash_iter cso_hash_erase(struct cso_hash *hash, struct cso_hash_iter iter)
 {
-   struct cso_hash_iter ret = iter;
-   struct cso_node *node = iter.node;
-   struct cso_node **node_ptr;
+   struct cso_hash_iter ret;
 
-   if (node == hash->end)
+   if (!iter.node)
       return iter;
 
-   ret = cso_hash_iter_next(ret);
-   node_ptr = &hash->buckets[node->key % hash->numBuckets];
-   while (*node_ptr != node)
-      node_ptr = &(*node_ptr)->next;
-   *node_ptr = node->next;
-   FREE(node);
-   --hash->size;
+   ret = cso_hash_iter_next(iter);
+   cso_data_remove(hash, iter.node);
    return ret;
 }
 
 bool cso_hash_contains(struct cso_hash *hash, unsigned key)
 {
-   struct cso_node **node = cso_hash_find_node(hash, key);
-   return *node != hash->end;
+   return !cso_hash_iter_is_null(cso_hash_find(hash, key));
 }
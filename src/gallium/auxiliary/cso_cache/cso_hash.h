@@ -29,14 +29,15 @@
  * @file
  * Hash table implementation.
  * 
- * This file provides a hash implementation that is capable of dealing
- * with collisions. It stores colliding entries in linked list. All
- * functions operating on the hash return an iterator. The iterator
- * itself points to the collision list. If there wasn't any collision
- * the list will have just one entry, otherwise client code should
- * iterate over the entries to find the exact entry among ones that
- * had the same key (e.g. memcmp could be used on the data to check
- * that)
+ * This file provides an open-addressing hash table with linear probing,
+ * storing the key and the value of each entry inline in one array of
+ * slots. Several entries may share the same key. All functions operating
+ * on the hash return an iterator; cso_hash_find() returns the first entry
+ * with a given key and cso_hash_find_next() the following ones, so client
+ * code can look for the exact entry among the ones that have the same key
+ * (e.g. memcmp could be used on the data to check that).
+ *
+ * Values must not be NULL, which marks an empty slot.
  * 
  * @author Zack Rusin <zackr@vmware.com>
  */
@@ -52,7 +53,6 @@ extern "C" {
 
 
 struct cso_node {
-   struct cso_node *next;
    void *value;
    unsigned key;
 };
@@ -62,14 +62,16 @@ struct cso_hash_iter {
    struct cso_node  *node;
 };
 
+/**
+ * Erased entries leave a tombstone behind, so that probe sequences going
+ * through them keep working. A tombstone is a slot whose value points to
+ * the hash itself.
+ */
 struct cso_hash {
-   struct cso_node *fakeNext;
-   struct cso_node **buckets;
-   struct cso_node *end;
-   int size;
-   short userNumBits;
-   short numBits;
-   int numBuckets;
+   struct cso_node *nodes;
+   unsigned size;
+   unsigned deleted;
+   unsigned numBits;
 };
 
 void cso_hash_init(struct cso_hash *hash);
@@ -80,10 +82,10 @@ int cso_hash_size(struct cso_hash *hash);
 
 
 /**
- * Adds a data with the given key to the hash. If entry with the given
- * key is already in the hash, this current entry is instered before it
- * in the collision list.
+ * Adds a data with the given key to the hash. Entries with the given
+ * key already in the hash are kept.
  * Function returns iterator pointing to the inserted item in the hash.
+ * May reallocate the table, invalidating all other iterators.
  */
 struct cso_hash_iter cso_hash_insert(struct cso_hash *hash, unsigned key,
                                      void *data);
@@ -111,67 +113,90 @@ bool cso_hash_contains(struct cso_hash *hash, unsigned key);
 unsigned cso_hash_iter_key(struct cso_hash_iter iter);
 
 
-struct cso_hash_iter cso_hash_iter_prev(struct cso_hash_iter iter);
+/**
+ * Returns an iterator pointing to the next item in the hash, in no
+ * particular order, for walking all the items.
+ */
+struct cso_hash_iter cso_hash_iter_next(struct cso_hash_iter iter);
 
 
 /**
- * Convenience routine to iterate over the collision list while doing a memory
- * comparison to see which entry in the list is a direct copy of our template
- * and returns that entry.
+ * Convenience routine to iterate over the entries with the given key while
+ * doing a memory comparison to see which entry is a direct copy of our
+ * template and returns that entry.
  */
 void *cso_hash_find_data_from_template(struct cso_hash *hash,
 				       unsigned hash_key,
 				       void *templ,
 				       int size);
 
-struct cso_node *cso_hash_data_next(struct cso_node *node);
-
 static inline bool
 cso_hash_iter_is_null(struct cso_hash_iter iter)
 {
-   return !iter.node || iter.node == iter.hash->end;
+   return !iter.node;
 }
 
 static inline void *
 cso_hash_iter_data(struct cso_hash_iter iter)
 {
-   if (!iter.node || iter.hash->end == iter.node)
+   if (!iter.node)
       return NULL;
    return iter.node->value;
 }
 
-static inline struct cso_node **
-cso_hash_find_node(struct cso_hash *hash, unsigned akey)
+static inline unsigned
+cso_hash_bucket(const struct cso_hash *hash, unsigned akey)
+{
+   /* Keys don't need to be well distributed, multiplicative hashing
+    * spreads them over the table.
+    */
+   return (akey * 2654435761u) >> (32 - hash->numBits);
+}
+
+/**
+ * Probe for \p akey from slot \p i onwards, stopping at the first empty
+ * slot. The load factor is kept below 1 so that there always is one.
+ */
+static inline struct cso_node *
+cso_hash_probe(struct cso_hash *hash, unsigned akey, unsigned i)
 {
-   struct cso_node **node;
-
-   if (hash->numBuckets) {
-      node = &hash->buckets[akey % hash->numBuckets];
-      assert(*node == hash->end || (*node)->next);
-      while (*node != hash->end && (*node)->key != akey)
-         node = &(*node)->next;
-   } else {
-      node = &hash->end;
+   const unsigned mask = (1u << hash->numBits) - 1;
+
+   for (;; i = (i + 1) & mask) {
+      struct cso_node *node = &hash->nodes[i];
+
+      if (!node->value)
+         return NULL;
+      if (node->key == akey && node->value != (void *)hash)
+         return node;
    }
-   return node;
 }
 
 /**
- * Return an iterator pointing to the first entry in the collision list.
+ * Return an iterator pointing to the first entry with the given key.
  */
 static inline struct cso_hash_iter
 cso_hash_find(struct cso_hash *hash, unsigned key)
 {
-   struct cso_node **nextNode = cso_hash_find_node(hash, key);
-   struct cso_hash_iter iter = {hash, *nextNode};
+   struct cso_hash_iter iter = {hash, NULL};
+
+   if (hash->nodes)
+      iter.node = cso_hash_probe(hash, key, cso_hash_bucket(hash, key));
    return iter;
 }
 
+/**
+ * Return an iterator pointing to the next entry with the same key as the
+ * one \p iter points to, or a null iterator.
+ */
 static inline struct cso_hash_iter
-cso_hash_iter_next(struct cso_hash_iter iter)
+cso_hash_find_next(struct cso_hash_iter iter)
 {
-   struct cso_hash_iter next = {iter.hash, cso_hash_data_next(iter.node)};
-   return next;
+   struct cso_hash *hash = iter.hash;
+   unsigned next = ((iter.node - hash->nodes) + 1) &
+                   ((1u << hash->numBits) - 1);
+   struct cso_hash_iter ret = {hash, cso_hash_probe(hash, iter.node->key, next)};
+   return ret;
 }
 
 #ifdef	__cplusplus
@@ -719,3 +719,14 @@ gallivm_jit_function(struct gallivm_state *gallivm,
 
    return jit_func;
 }
+
+
+/**
+ * Bytes of JIT code and data generated so far.  Still valid after
+ * gallivm_free_ir().
+ */
+size_t
+gallivm_code_size(const struct gallivm_state *gallivm)
+{
+   return lp_generated_code_size(gallivm->code);
+}
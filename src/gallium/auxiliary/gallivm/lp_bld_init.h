@@ -85,6 +85,9 @@ func_pointer
 gallivm_jit_function(struct gallivm_state *gallivm,
                      LLVMValueRef func);
 
+size_t
+gallivm_code_size(const struct gallivm_state *gallivm);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1568,6 +1568,82 @@ fetch_src_file_channel(const struct tgsi_exec_machine *mach,
    }
 }
 
+/**
+ * Fetch a channel of a register that isn't addressed indirectly, which
+ * makes the index the same for all the lanes.  Returns false for register
+ * files that need fetch_src_file_channel().
+ */
+static boolean
+fetch_src_file_channel_direct(const struct tgsi_exec_machine *mach,
+                              const uint file,
+                              const uint swizzle,
+                              const int index,
+                              const int index2D,
+                              union tgsi_exec_channel *chan)
+{
+   assert(swizzle < 4);
+
+   switch (file) {
+   case TGSI_FILE_CONSTANT: {
+      const uint *buf = (const uint *)mach->Consts[index2D];
+      const int pos = index * 4 + swizzle;
+      uint value = 0;
+
+      assert(index2D >= 0 && index2D < PIPE_MAX_CONSTANT_BUFFERS);
+      assert(buf);
+
+      /* const buffer bounds check */
+      if (index >= 0 && pos < (int) mach->ConstsSize[index2D])
+         value = buf[pos];
+
+      chan->u[0] = chan->u[1] = chan->u[2] = chan->u[3] = value;
+      return TRUE;
+   }
+
+   case TGSI_FILE_INPUT: {
+      const int pos = index2D * TGSI_EXEC_MAX_INPUT_ATTRIBS + index;
+
+      assert(pos >= 0);
+      assert(pos < TGSI_MAX_PRIM_VERTICES * PIPE_MAX_ATTRIBS);
+      *chan = mach->Inputs[pos].xyzw[swizzle];
+      return TRUE;
+   }
+
+   case TGSI_FILE_SYSTEM_VALUE:
+      *chan = mach->SystemValue[index].xyzw[swizzle];
+      return TRUE;
+
+   case TGSI_FILE_TEMPORARY:
+      assert(index < TGSI_EXEC_NUM_TEMPS);
+      assert(index2D == 0);
+      *chan = mach->Temps[index].xyzw[swizzle];
+      return TRUE;
+
+   case TGSI_FILE_IMMEDIATE:
+      assert(index >= 0 && index < (int)mach->ImmLimit);
+      assert(index2D == 0);
+      chan->f[0] = chan->f[1] = chan->f[2] = chan->f[3] =
+         mach->Imms[index][swizzle];
+      return TRUE;
+
+   case TGSI_FILE_ADDRESS:
+      assert(index >= 0);
+      assert(index2D == 0);
+      *chan = mach->Addrs[index].xyzw[swizzle];
+      return TRUE;
+
+   case TGSI_FILE_OUTPUT:
+      /* vertex/fragment output vars can be read too */
+      assert(index >= 0);
+      assert(index2D == 0);
+      *chan = mach->Outputs[index].xyzw[swizzle];
+      return TRUE;
+
+   default:
+      return FALSE;
+   }
+}
+
 static void
 get_index_registers(const struct tgsi_exec_machine *mach,
                     const struct tgsi_full_src_register *reg,
@@ -1715,10 +1791,24 @@ fetch_source_d(const struct tgsi_exec_machine *mach,
    union tgsi_exec_channel index2D;
    uint swizzle;
 
-   get_index_registers(mach, reg, &index, &index2D);
+   swizzle = tgsi_util_get_full_src_register_swizzle( reg, chan_index );
 
+   /* Most operands are addressed directly, fetch those without building
+    * per-lane index registers.
+    */
+   if (!reg->Register.Indirect &&
+       !(reg->Register.Dimension && reg->Dimension.Indirect) &&
+       fetch_src_file_channel_direct(mach,
+                                     reg->Register.File,
+                                     swizzle,
+                                     reg->Register.Index,
+                                     reg->Register.Dimension ?
+                                     reg->Dimension.Index : 0,
+                                     chan))
+      return;
+
+   get_index_registers(mach, reg, &index, &index2D);
 
-   swizzle = tgsi_util_get_full_src_register_swizzle( reg, chan_index );
    fetch_src_file_channel(mach,
                           reg->Register.File,
                           swizzle,
@@ -1958,6 +2048,13 @@ store_dest(struct tgsi_exec_machine *mach,
       return;
 
    if (!inst->Instruction.Saturate) {
+      const uint all_lanes = (1 << TGSI_QUAD_SIZE) - 1;
+
+      if ((execmask & all_lanes) == all_lanes) {
+         *dst = *chan;
+         return;
+      }
+
       for (i = 0; i < TGSI_QUAD_SIZE; i++)
          if (execmask & (1 << i))
             dst->i[i] = chan->i[i];
@@ -40,6 +40,7 @@
 #include "util/u_upload_mgr.h"
 #include "lp_clear.h"
 #include "lp_context.h"
+#include "lp_debug.h"
 #include "lp_flush.h"
 #include "lp_perf.h"
 #include "lp_state.h"
@@ -60,6 +61,9 @@ static void llvmpipe_destroy( struct pipe_context *pipe )
 
    lp_print_counters();
 
+   if (llvmpipe->fs_compile_context)
+      util_queue_destroy(&llvmpipe->fs_compile_queue);
+
    if (llvmpipe->csctx) {
       lp_csctx_destroy(llvmpipe->csctx);
    }
@@ -104,8 +108,11 @@ static void llvmpipe_destroy( struct pipe_context *pipe )
 
 #ifndef USE_GLOBAL_LLVM_CONTEXT
    LLVMContextDispose(llvmpipe->context);
+   if (llvmpipe->fs_compile_context)
+      LLVMContextDispose(llvmpipe->fs_compile_context);
 #endif
    llvmpipe->context = NULL;
+   llvmpipe->fs_compile_context = NULL;
 
    align_free( llvmpipe );
 }
@@ -218,6 +225,17 @@ llvmpipe_create_context(struct pipe_screen *screen, void *priv,
    if (!llvmpipe->context)
       goto fail;
 
+#ifndef USE_GLOBAL_LLVM_CONTEXT
+   if (!(LP_PERF & PERF_NO_FS_PRECOMPILE) &&
+       util_queue_init(&llvmpipe->fs_compile_queue, "lpfs", 32, 1,
+                       UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                       UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY)) {
+      llvmpipe->fs_compile_context = LLVMContextCreate();
+      if (!llvmpipe->fs_compile_context)
+         util_queue_destroy(&llvmpipe->fs_compile_queue);
+   }
+#endif
+
    /*
     * Create drawing context and plug our rendering stage into it.
     */
@@ -35,6 +35,7 @@
 
 #include "draw/draw_vertex.h"
 #include "util/u_blitter.h"
+#include "util/u_queue.h"
 
 #include "lp_tex_sample.h"
 #include "lp_jit.h"
@@ -155,6 +156,14 @@ struct llvmpipe_context {
    struct lp_fs_variant_list_item fs_variants_list;
    unsigned nr_fs_variants;
    unsigned nr_fs_instrs;
+   uint64_t fs_variants_size;
+
+   /** Fragment shader variant cache counters, see lp_query.h */
+   struct {
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t evictions;
+   } fs_variant_stats;
 
    struct lp_setup_variant_list_item setup_variants_list;
    unsigned nr_setup_variants;
@@ -173,6 +182,14 @@ struct llvmpipe_context {
    /** The LLVMContext to use for LLVM related work */
    LLVMContextRef context;
 
+   /**
+    * Single-threaded queue compiling predicted fragment shader variants
+    * ahead of their first draw, and the LLVMContext only it uses.  The
+    * context is NULL if compile-ahead is disabled.
+    */
+   struct util_queue fs_compile_queue;
+   LLVMContextRef fs_compile_context;
+
    int max_global_buffers;
    struct pipe_resource **global_buffers;
 
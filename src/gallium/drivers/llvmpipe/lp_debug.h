@@ -59,6 +59,7 @@
 #define PERF_NO_BLEND       0x20  	/* disable blending */
 #define PERF_NO_DEPTH       0x40  	/* disable depth buffering entirely */
 #define PERF_NO_ALPHATEST   0x80  	/* disable alpha testing */
+#define PERF_NO_FS_PRECOMPILE 0x100	/* don't compile predicted FS variants ahead */
 
 
 extern int LP_PERF;
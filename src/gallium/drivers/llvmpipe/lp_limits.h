@@ -86,6 +86,19 @@
  */
 #define LP_MAX_SHADER_INSTRUCTIONS (2048 * LP_MAX_SHADER_VARIANTS)
 
+/**
+ * Max bytes of memory, mostly JIT code and data, held by the fragment
+ * shader variants of a context.
+ */
+#define LP_MAX_SHADER_VARIANT_MEMORY (64 * 1024 * 1024)
+
+/**
+ * When one of the fragment shader variant limits above is reached, the
+ * least recently used variants are evicted until the context is below
+ * this many sixteenths of every limit.
+ */
+#define LP_SHADER_VARIANT_LOW_WATER 15
+
 /**
  * Max number of setup variants that will be kept around.
  *
@@ -55,7 +55,9 @@ llvmpipe_create_query(struct pipe_context *pipe,
 {
    struct llvmpipe_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES ||
+          (type >= LP_QUERY_FIRST_DRIVER_SPECIFIC &&
+           type <= LP_QUERY_LAST_DRIVER_SPECIFIC));
 
    pq = CALLOC_STRUCT( llvmpipe_query );
 
@@ -68,6 +70,36 @@ llvmpipe_create_query(struct pipe_context *pipe,
 }
 
 
+static bool
+is_driver_query(const struct llvmpipe_query *pq)
+{
+   return pq->type >= LP_QUERY_FIRST_DRIVER_SPECIFIC;
+}
+
+
+/**
+ * Current value of a driver-specific query.
+ */
+static uint64_t
+get_driver_query_value(const struct llvmpipe_context *llvmpipe,
+                       unsigned type)
+{
+   switch (type) {
+   case LP_QUERY_FS_VARIANT_HITS:
+      return llvmpipe->fs_variant_stats.hits;
+   case LP_QUERY_FS_VARIANT_MISSES:
+      return llvmpipe->fs_variant_stats.misses;
+   case LP_QUERY_FS_VARIANT_EVICTIONS:
+      return llvmpipe->fs_variant_stats.evictions;
+   case LP_QUERY_FS_VARIANT_MEMORY:
+      return llvmpipe->fs_variants_size;
+   default:
+      assert(0);
+      return 0;
+   }
+}
+
+
 static void
 llvmpipe_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
 {
@@ -182,6 +214,12 @@ llvmpipe_get_query_result(struct pipe_context *pipe,
       *stats = pq->stats;
    }
       break;
+   case LP_QUERY_FS_VARIANT_HITS:
+   case LP_QUERY_FS_VARIANT_MISSES:
+   case LP_QUERY_FS_VARIANT_EVICTIONS:
+   case LP_QUERY_FS_VARIANT_MEMORY:
+      *result = pq->end[0];
+      break;
    default:
       assert(0);
       break;
@@ -308,6 +346,12 @@ llvmpipe_get_query_result_resource(struct pipe_context *pipe,
             break;
          }
          break;
+      case LP_QUERY_FS_VARIANT_HITS:
+      case LP_QUERY_FS_VARIANT_MISSES:
+      case LP_QUERY_FS_VARIANT_EVICTIONS:
+      case LP_QUERY_FS_VARIANT_MEMORY:
+         value = pq->end[0];
+         break;
       default:
          fprintf(stderr, "Unknown query type %d\n", pq->type);
          break;
@@ -351,6 +395,12 @@ llvmpipe_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    struct llvmpipe_context *llvmpipe = llvmpipe_context( pipe );
    struct llvmpipe_query *pq = llvmpipe_query(q);
 
+   /* Driver queries read context counters and are never binned. */
+   if (is_driver_query(pq)) {
+      pq->start[0] = get_driver_query_value(llvmpipe, pq->type);
+      return true;
+   }
+
    /* Check if the query is already in the scene.  If so, we need to
     * flush the scene now.  Real apps shouldn't re-use a query in a
     * frame of rendering.
@@ -414,6 +464,13 @@ llvmpipe_end_query(struct pipe_context *pipe, struct pipe_query *q)
    struct llvmpipe_context *llvmpipe = llvmpipe_context( pipe );
    struct llvmpipe_query *pq = llvmpipe_query(q);
 
+   if (is_driver_query(pq)) {
+      pq->end[0] = get_driver_query_value(llvmpipe, pq->type);
+      if (pq->type != LP_QUERY_FS_VARIANT_MEMORY)
+         pq->end[0] -= pq->start[0];
+      return true;
+   }
+
    lp_setup_end_query(llvmpipe->setup, pq);
 
    switch (pq->type) {
@@ -517,6 +574,56 @@ llvmpipe_set_active_query_state(struct pipe_context *pipe, bool enable)
    llvmpipe->dirty |= LP_NEW_OCCLUSION_QUERY;
 }
 
+static const struct pipe_driver_query_info llvmpipe_driver_query_list[] = {
+   {"fs-variant-hits", LP_QUERY_FS_VARIANT_HITS, { 0 },
+    PIPE_DRIVER_QUERY_TYPE_UINT64, PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE},
+   {"fs-variant-misses", LP_QUERY_FS_VARIANT_MISSES, { 0 },
+    PIPE_DRIVER_QUERY_TYPE_UINT64, PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE},
+   {"fs-variant-evictions", LP_QUERY_FS_VARIANT_EVICTIONS, { 0 },
+    PIPE_DRIVER_QUERY_TYPE_UINT64, PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE},
+   {"fs-variant-memory", LP_QUERY_FS_VARIANT_MEMORY, { 0 },
+    PIPE_DRIVER_QUERY_TYPE_BYTES, PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE},
+};
+
+
+int
+llvmpipe_get_driver_query_info(struct pipe_screen *screen,
+                               unsigned index,
+                               struct pipe_driver_query_info *info)
+{
+   if (!info)
+      return ARRAY_SIZE(llvmpipe_driver_query_list);
+
+   if (index >= ARRAY_SIZE(llvmpipe_driver_query_list))
+      return 0;
+
+   *info = llvmpipe_driver_query_list[index];
+   return 1;
+}
+
+
+/**
+ * All driver queries are in one group, which makes them available through
+ * GL_AMD_performance_monitor.
+ */
+int
+llvmpipe_get_driver_query_group_info(struct pipe_screen *screen,
+                                     unsigned index,
+                                     struct pipe_driver_query_group_info *info)
+{
+   if (!info)
+      return 1;
+
+   if (index > 0)
+      return 0;
+
+   info->name = "llvmpipe";
+   info->max_active_queries = ARRAY_SIZE(llvmpipe_driver_query_list);
+   info->num_queries = ARRAY_SIZE(llvmpipe_driver_query_list);
+   return 1;
+}
+
+
 void llvmpipe_init_query_funcs(struct llvmpipe_context *llvmpipe )
 {
    llvmpipe->pipe.create_query = llvmpipe_create_query;
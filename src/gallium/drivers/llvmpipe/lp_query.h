@@ -35,10 +35,26 @@
 
 #include <limits.h>
 #include "os/os_thread.h"
+#include "pipe/p_defines.h"
 #include "lp_limits.h"
 
 
 struct llvmpipe_context;
+struct pipe_driver_query_info;
+struct pipe_driver_query_group_info;
+
+
+/**
+ * Driver-specific queries on the fragment shader variant cache.  The
+ * counters return the change between begin and end, the memory query the
+ * bytes held by the cached variants at end.
+ */
+#define LP_QUERY_FS_VARIANT_HITS      (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define LP_QUERY_FS_VARIANT_MISSES    (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+#define LP_QUERY_FS_VARIANT_EVICTIONS (PIPE_QUERY_DRIVER_SPECIFIC + 2)
+#define LP_QUERY_FS_VARIANT_MEMORY    (PIPE_QUERY_DRIVER_SPECIFIC + 3)
+#define LP_QUERY_FIRST_DRIVER_SPECIFIC LP_QUERY_FS_VARIANT_HITS
+#define LP_QUERY_LAST_DRIVER_SPECIFIC  LP_QUERY_FS_VARIANT_MEMORY
 
 
 struct llvmpipe_query {
@@ -56,6 +72,14 @@ struct llvmpipe_query {
 
 extern void llvmpipe_init_query_funcs(struct llvmpipe_context * );
 
+extern int llvmpipe_get_driver_query_info(struct pipe_screen *screen,
+                                          unsigned index,
+                                          struct pipe_driver_query_info *info);
+
+extern int llvmpipe_get_driver_query_group_info(struct pipe_screen *screen,
+                                                unsigned index,
+                                                struct pipe_driver_query_group_info *info);
+
 extern boolean llvmpipe_check_render_cond(struct llvmpipe_context *);
 
 #endif /* LP_QUERY_H */
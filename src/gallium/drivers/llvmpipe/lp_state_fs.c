@@ -109,6 +109,7 @@
 #include "lp_screen.h"
 #include "compiler/nir/nir_serialize.h"
 #include "util/mesa-sha1.h"
+#include "util/disk_cache.h"
 /** Fragment shader number (for debugging) */
 static unsigned fs_no = 0;
 
@@ -2905,8 +2906,7 @@ generate_unswizzled_blend(struct gallivm_state *gallivm,
  * 2x2 pixels.
  */
 static void
-generate_fragment(struct llvmpipe_context *lp,
-                  struct lp_fragment_shader *shader,
+generate_fragment(struct lp_fragment_shader *shader,
                   struct lp_fragment_shader_variant *variant,
                   unsigned partial_mask)
 {
@@ -3459,13 +3459,15 @@ lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
 /**
  * Generate a new fragment shader variant from the shader code and
  * other state indicated by the key.
+ *
+ * The caller must hold the shader's compile_mutex.
  */
 static struct lp_fragment_shader_variant *
-generate_variant(struct llvmpipe_context *lp,
+generate_variant(struct llvmpipe_screen *screen,
+                 LLVMContextRef context,
                  struct lp_fragment_shader *shader,
                  const struct lp_fragment_shader_variant_key *key)
 {
-   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader_variant *variant;
    const struct util_format_description *cbuf0_format_desc = NULL;
    boolean fullcolormask;
@@ -3491,7 +3493,7 @@ generate_variant(struct llvmpipe_context *lp,
       if (!cached.data_size)
          needs_caching = true;
    }
-   variant->gallivm = gallivm_create(module_name, lp->context, &cached);
+   variant->gallivm = gallivm_create(module_name, context, &cached);
    if (!variant->gallivm) {
       FREE(variant);
       return NULL;
@@ -3532,12 +3534,12 @@ generate_variant(struct llvmpipe_context *lp,
    lp_jit_init_types(variant);
    
    if (variant->jit_function[RAST_EDGE_TEST] == NULL)
-      generate_fragment(lp, shader, variant, RAST_EDGE_TEST);
+      generate_fragment(shader, variant, RAST_EDGE_TEST);
 
    if (variant->jit_function[RAST_WHOLE] == NULL) {
       if (variant->opaque) {
          /* Specialized shader, which doesn't need to read the color buffer. */
-         generate_fragment(lp, shader, variant, RAST_WHOLE);
+         generate_fragment(shader, variant, RAST_WHOLE);
       }
    }
 
@@ -3567,12 +3569,242 @@ generate_variant(struct llvmpipe_context *lp,
       lp_disk_cache_insert_shader(screen, &cached, ir_sha1_cache_key);
    }
 
+   /* The LLVM IR is freed below, so what stays is the JIT code and data. */
+   variant->size = sizeof *variant - sizeof variant->key +
+                   shader->variant_key_size +
+                   sizeof *variant->gallivm +
+                   gallivm_code_size(variant->gallivm);
+
    gallivm_free_ir(variant->gallivm);
 
    return variant;
 }
 
 
+/*
+ * Fragment shader variant compile-ahead.
+ *
+ * Creating a variant in llvmpipe_update_fs stalls the draw on LLVM codegen.
+ * To hide that, the variant keys each shader is used with are stored in the
+ * disk cache under a hash of the shader IR.  When a shader with the same IR
+ * is created again, those variants are compiled on the context's compile
+ * queue right away, and llvmpipe_update_fs picks them up instead of
+ * compiling.
+ */
+
+struct lp_fs_precompile_job {
+   struct llvmpipe_screen *screen;
+   LLVMContextRef context;
+   struct lp_fragment_shader *shader;
+   struct util_queue_fence fence;
+   struct lp_fragment_shader_variant *variant;
+
+   /* Must be last, the key is variable-sized */
+   struct lp_fragment_shader_variant_key key;
+};
+
+
+static void
+lp_fs_compute_ir_sha1(struct lp_fragment_shader *shader)
+{
+   static const char tag[] = "llvmpipe fs variant keys";
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, tag, sizeof tag);
+   _mesa_sha1_update(&ctx, &shader->variant_key_size,
+                     sizeof shader->variant_key_size);
+
+   if (shader->base.ir.nir) {
+      struct blob blob;
+
+      blob_init(&blob);
+      nir_serialize(&blob, shader->base.ir.nir, true);
+      _mesa_sha1_update(&ctx, blob.data, blob.size);
+      blob_finish(&blob);
+   } else {
+      _mesa_sha1_update(&ctx, shader->base.tokens,
+                        tgsi_num_tokens(shader->base.tokens) *
+                        sizeof(struct tgsi_token));
+   }
+
+   _mesa_sha1_final(&ctx, shader->ir_sha1);
+}
+
+
+static void
+lp_fs_precompile_execute(void *data, int thread_index)
+{
+   struct lp_fs_precompile_job *job = data;
+   struct lp_fragment_shader *shader = job->shader;
+
+   mtx_lock(&shader->compile_mutex);
+   job->variant = generate_variant(job->screen, job->context, shader,
+                                   &job->key);
+   mtx_unlock(&shader->compile_mutex);
+}
+
+
+/**
+ * Load the variant keys previously used with this shader's IR, and queue
+ * compiles for them.
+ */
+static void
+lp_fs_precompile_variants(struct llvmpipe_context *lp,
+                          struct lp_fragment_shader *shader)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   const unsigned key_size = shader->variant_key_size;
+   cache_key history_key;
+   size_t size;
+   uint8_t *history;
+   unsigned i;
+
+   if (!screen->disk_shader_cache)
+      return;
+
+   shader->key_history = MALLOC(LP_FS_MAX_PREDICTED_VARIANTS * key_size);
+   if (!shader->key_history)
+      return;
+
+   lp_fs_compute_ir_sha1(shader);
+
+   disk_cache_compute_key(screen->disk_shader_cache, shader->ir_sha1,
+                          sizeof shader->ir_sha1, history_key);
+   history = disk_cache_get(screen->disk_shader_cache, history_key, &size);
+   if (!history)
+      return;
+
+   /* Ignore anything that isn't a list of keys of the expected size. */
+   if (size % key_size == 0 &&
+       size <= LP_FS_MAX_PREDICTED_VARIANTS * key_size) {
+      memcpy(shader->key_history, history, size);
+      shader->key_history_len = size / key_size;
+   }
+   free(history);
+
+   if (!lp->fs_compile_context)
+      return;
+
+   for (i = 0; i < shader->key_history_len; i++) {
+      struct lp_fs_precompile_job *job;
+
+      job = CALLOC(1, sizeof *job - sizeof job->key + key_size);
+      if (!job)
+         break;
+
+      job->screen = screen;
+      job->context = lp->fs_compile_context;
+      job->shader = shader;
+      memcpy(&job->key, shader->key_history + i * key_size, key_size);
+      util_queue_fence_init(&job->fence);
+
+      shader->precompiles[shader->num_precompiles++] = job;
+      util_queue_add_job(&lp->fs_compile_queue, job, &job->fence,
+                         lp_fs_precompile_execute, NULL, 0);
+   }
+}
+
+
+/**
+ * Return the variant compiled ahead for this key, if any.  A compile that
+ * hasn't started yet is dropped, as doing it right here is no slower.
+ */
+static struct lp_fragment_shader_variant *
+lp_fs_claim_precompiled_variant(struct llvmpipe_context *lp,
+                                struct lp_fragment_shader *shader,
+                                const struct lp_fragment_shader_variant_key *key)
+{
+   unsigned i;
+
+   for (i = 0; i < shader->num_precompiles; i++) {
+      struct lp_fs_precompile_job *job = shader->precompiles[i];
+      struct lp_fragment_shader_variant *variant;
+
+      if (memcmp(&job->key, key, shader->variant_key_size) != 0)
+         continue;
+
+      util_queue_drop_job(&lp->fs_compile_queue, &job->fence);
+      variant = job->variant;
+
+      util_queue_fence_destroy(&job->fence);
+      FREE(job);
+      shader->precompiles[i] = shader->precompiles[--shader->num_precompiles];
+
+      return variant;
+   }
+
+   return NULL;
+}
+
+
+/**
+ * Cancel or wait for the shader's outstanding compiles, and free the
+ * variants nobody claimed.
+ */
+static void
+lp_fs_drop_precompiled_variants(struct llvmpipe_context *lp,
+                                struct lp_fragment_shader *shader)
+{
+   unsigned i;
+
+   for (i = 0; i < shader->num_precompiles; i++) {
+      struct lp_fs_precompile_job *job = shader->precompiles[i];
+
+      util_queue_drop_job(&lp->fs_compile_queue, &job->fence);
+      if (job->variant) {
+         gallivm_destroy(job->variant->gallivm);
+         FREE(job->variant);
+      }
+
+      util_queue_fence_destroy(&job->fence);
+      FREE(job);
+   }
+
+   shader->num_precompiles = 0;
+}
+
+
+/**
+ * Add the key to the shader's variant key history, and write the history
+ * back to the disk cache if the key is new.
+ */
+static void
+lp_fs_record_variant_key(struct llvmpipe_context *lp,
+                         struct lp_fragment_shader *shader,
+                         const struct lp_fragment_shader_variant_key *key)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   const unsigned key_size = shader->variant_key_size;
+   cache_key history_key;
+   unsigned i;
+
+   if (!shader->key_history)
+      return;
+
+   for (i = 0; i < shader->key_history_len; i++) {
+      if (memcmp(shader->key_history + i * key_size, key, key_size) == 0)
+         return;
+   }
+
+   /* Forget the oldest key once the history is full. */
+   if (shader->key_history_len == LP_FS_MAX_PREDICTED_VARIANTS) {
+      memmove(shader->key_history, shader->key_history + key_size,
+              (LP_FS_MAX_PREDICTED_VARIANTS - 1) * key_size);
+      shader->key_history_len--;
+   }
+
+   memcpy(shader->key_history + shader->key_history_len * key_size,
+          key, key_size);
+   shader->key_history_len++;
+
+   disk_cache_compute_key(screen->disk_shader_cache, shader->ir_sha1,
+                          sizeof shader->ir_sha1, history_key);
+   disk_cache_put(screen->disk_shader_cache, history_key, shader->key_history,
+                  shader->key_history_len * key_size, NULL);
+}
+
+
 static void *
 llvmpipe_create_fs_state(struct pipe_context *pipe,
                          const struct pipe_shader_state *templ)
@@ -3590,6 +3822,7 @@ llvmpipe_create_fs_state(struct pipe_context *pipe,
 
    shader->no = fs_no++;
    make_empty_list(&shader->variants);
+   (void) mtx_init(&shader->compile_mutex, mtx_plain);
 
    shader->base.type = templ->type;
    if (templ->type == PIPE_SHADER_IR_TGSI) {
@@ -3605,6 +3838,7 @@ llvmpipe_create_fs_state(struct pipe_context *pipe,
 
    shader->draw_data = draw_create_fragment_shader(llvmpipe->draw, templ);
    if (shader->draw_data == NULL) {
+      mtx_destroy(&shader->compile_mutex);
       FREE((void *) shader->base.tokens);
       FREE(shader);
       return NULL;
@@ -3672,6 +3906,8 @@ llvmpipe_create_fs_state(struct pipe_context *pipe,
       debug_printf("\n");
    }
 
+   lp_fs_precompile_variants(llvmpipe, shader);
+
    return shader;
 }
 
@@ -3720,6 +3956,7 @@ llvmpipe_remove_shader_variant(struct llvmpipe_context *lp,
    remove_from_list(&variant->list_item_global);
    lp->nr_fs_variants--;
    lp->nr_fs_instrs -= variant->nr_instrs;
+   lp->fs_variants_size -= variant->size;
 
    FREE(variant);
 }
@@ -3741,6 +3978,8 @@ llvmpipe_delete_fs_state(struct pipe_context *pipe, void *fs)
     */
    llvmpipe_finish(pipe, __FUNCTION__);
 
+   lp_fs_drop_precompiled_variants(llvmpipe, shader);
+
    /* Delete all the variants */
    li = first_elem(&shader->variants);
    while(!at_end(&shader->variants, li)) {
@@ -3755,6 +3994,8 @@ llvmpipe_delete_fs_state(struct pipe_context *pipe, void *fs)
    if (shader->base.ir.nir)
       ralloc_free(shader->base.ir.nir);
    assert(shader->variants_cached == 0);
+   mtx_destroy(&shader->compile_mutex);
+   FREE(shader->key_history);
    FREE((void *) shader->base.tokens);
    FREE(shader);
 }
@@ -4130,6 +4371,23 @@ make_variant_key(struct llvmpipe_context *lp,
 
 
 
+/**
+ * Whether the fragment shader variants of the context have reached
+ * sixteenths/16 of the variant count, instruction or memory limit.
+ */
+static boolean
+fs_variants_over_limits(const struct llvmpipe_context *lp,
+                        unsigned sixteenths)
+{
+   return lp->nr_fs_variants >=
+             LP_MAX_SHADER_VARIANTS / 16 * sixteenths ||
+          lp->nr_fs_instrs >=
+             LP_MAX_SHADER_INSTRUCTIONS / 16 * sixteenths ||
+          lp->fs_variants_size >=
+             (uint64_t)LP_MAX_SHADER_VARIANT_MEMORY / 16 * sixteenths;
+}
+
+
 /**
  * Update fragment shader state.  This is called just prior to drawing
  * something when some fragment-related state has changed.
@@ -4160,12 +4418,13 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
        * deletion of shader's when we have too many.
        */
       move_to_head(&lp->fs_variants_list, &variant->list_item_global);
+      lp->fs_variant_stats.hits++;
    }
    else {
       /* variant not found, create it now */
       int64_t t0, t1, dt;
-      unsigned i;
-      unsigned variants_to_cull;
+
+      lp->fs_variant_stats.misses++;
 
       if (LP_DEBUG & DEBUG_FS) {
          debug_printf("%u variants,\t%u instrs,\t%u instrs/variant\n",
@@ -4174,21 +4433,21 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
                       lp->nr_fs_variants ? lp->nr_fs_instrs / lp->nr_fs_variants : 0);
       }
 
-      /* First, check if we've exceeded the max number of shader variants.
-       * If so, free 6.25% of them (the least recently used ones).
+      /* First, check if we've exceeded the max number of shader variants,
+       * instructions or variant memory.  If so, free the least recently
+       * used variants until we are under the low-water mark of all the
+       * limits, so that the finish below is not paid on every miss.
        */
-      variants_to_cull = lp->nr_fs_variants >= LP_MAX_SHADER_VARIANTS ? LP_MAX_SHADER_VARIANTS / 16 : 0;
-
-      if (variants_to_cull ||
-          lp->nr_fs_instrs >= LP_MAX_SHADER_INSTRUCTIONS) {
+      if (fs_variants_over_limits(lp, 16)) {
          struct pipe_context *pipe = &lp->pipe;
 
          if (gallivm_debug & GALLIVM_DEBUG_PERF) {
             debug_printf("Evicting FS: %u fs variants,\t%u total variants,"
-                         "\t%u instrs,\t%u instrs/variant\n",
+                         "\t%u instrs,\t%u instrs/variant,\t%"PRIu64" bytes\n",
                          shader->variants_cached,
                          lp->nr_fs_variants, lp->nr_fs_instrs,
-                         lp->nr_fs_instrs / lp->nr_fs_variants);
+                         lp->nr_fs_instrs / lp->nr_fs_variants,
+                         lp->fs_variants_size);
          }
 
          /*
@@ -4199,32 +4458,40 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
          llvmpipe_finish(pipe, __FUNCTION__);
 
          /*
-          * We need to re-check lp->nr_fs_variants because an arbitrarliy large
+          * We need to re-check the limits because an arbitrarliy large
           * number of shader variants (potentially all of them) could be
           * pending for destruction on flush.
           */
 
-         for (i = 0; i < variants_to_cull || lp->nr_fs_instrs >= LP_MAX_SHADER_INSTRUCTIONS; i++) {
+         while (!is_empty_list(&lp->fs_variants_list) &&
+                fs_variants_over_limits(lp, LP_SHADER_VARIANT_LOW_WATER)) {
             struct lp_fs_variant_list_item *item;
-            if (is_empty_list(&lp->fs_variants_list)) {
-               break;
-            }
             item = last_elem(&lp->fs_variants_list);
             assert(item);
             assert(item->base);
             llvmpipe_remove_shader_variant(lp, item->base);
+            lp->fs_variant_stats.evictions++;
          }
       }
 
       /*
-       * Generate the new variant.
+       * Generate the new variant, unless it was compiled ahead.
        */
-      t0 = os_time_get();
-      variant = generate_variant(lp, shader, key);
-      t1 = os_time_get();
-      dt = t1 - t0;
-      LP_COUNT_ADD(llvm_compile_time, dt);
-      LP_COUNT_ADD(nr_llvm_compiles, 2);  /* emit vs. omit in/out test */
+      variant = lp_fs_claim_precompiled_variant(lp, shader, key);
+      if (!variant) {
+         t0 = os_time_get();
+         mtx_lock(&shader->compile_mutex);
+         variant = generate_variant(llvmpipe_screen(lp->pipe.screen),
+                                    lp->context, shader, key);
+         mtx_unlock(&shader->compile_mutex);
+         t1 = os_time_get();
+         dt = t1 - t0;
+         LP_COUNT_ADD(llvm_compile_time, dt);
+         LP_COUNT_ADD(nr_llvm_compiles, 2);  /* emit vs. omit in/out test */
+      }
+
+      if (variant)
+         lp_fs_record_variant_key(lp, shader, key);
 
       /* Put the new variant into the list */
       if (variant) {
@@ -4232,6 +4499,7 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
          insert_at_head(&lp->fs_variants_list, &variant->list_item_global);
          lp->nr_fs_variants++;
          lp->nr_fs_instrs += variant->nr_instrs;
+         lp->fs_variants_size += variant->size;
          shader->variants_cached++;
       }
    }
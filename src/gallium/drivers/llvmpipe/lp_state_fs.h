@@ -32,6 +32,7 @@
 
 #include "pipe/p_compiler.h"
 #include "pipe/p_state.h"
+#include "c11/threads.h"
 #include "tgsi/tgsi_scan.h" /* for tgsi_shader_info */
 #include "gallivm/lp_bld_sample.h" /* for struct lp_sampler_static_state */
 #include "gallivm/lp_bld_tgsi.h" /* for lp_tgsi_info */
@@ -144,6 +145,9 @@ struct lp_fragment_shader_variant
    /* Total number of LLVM instructions generated */
    unsigned nr_instrs;
 
+   /* Bytes of memory held by the variant, including its JIT code */
+   size_t size;
+
    struct lp_fs_variant_list_item list_item_global, list_item_local;
    struct lp_fragment_shader *shader;
 
@@ -155,6 +159,12 @@ struct lp_fragment_shader_variant
 };
 
 
+/** Max number of variant keys remembered per shader for compile-ahead */
+#define LP_FS_MAX_PREDICTED_VARIANTS 8
+
+struct lp_fs_precompile_job;
+
+
 /** Subclass of pipe_shader_state */
 struct lp_fragment_shader
 {
@@ -174,6 +184,24 @@ struct lp_fragment_shader
 
    /** Fragment shader input interpolation info */
    struct lp_shader_input inputs[PIPE_MAX_SHADER_INPUTS];
+
+   /**
+    * Serializes variant compiles, which may run on the context's compile
+    * queue as well as in llvmpipe_update_fs (the NIR is lowered in place).
+    */
+   mtx_t compile_mutex;
+
+   /** Variants being compiled ahead on the compile queue */
+   struct lp_fs_precompile_job *precompiles[LP_FS_MAX_PREDICTED_VARIANTS];
+   unsigned num_precompiles;
+
+   /**
+    * Variant keys used with this shader, oldest first, persisted in the disk
+    * cache under a hash of the shader IR so later runs can compile them ahead.
+    */
+   unsigned char ir_sha1[20];
+   char *key_history;
+   unsigned key_history_len;
 };
 
 
@@ -0,0 +1,429 @@
+/**************************************************************************
+ *
+ * Copyright 2020 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+/**
+ * @file
+ * Unit tests for the fragment shader variant cache: the hit, miss, eviction
+ * and memory accounting, the driver queries reporting it, and the LRU
+ * eviction down to the low-water mark.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "pipe/p_context.h"
+#include "pipe/p_screen.h"
+#include "pipe/p_state.h"
+#include "tgsi/tgsi_ureg.h"
+#include "util/simple_list.h"
+#include "util/u_memory.h"
+#include "sw/null/null_sw_winsys.h"
+
+#include "lp_context.h"
+#include "lp_limits.h"
+#include "lp_public.h"
+#include "lp_query.h"
+#include "lp_state.h"
+#include "lp_state_fs.h"
+#include "lp_test.h"
+
+
+enum {
+   HITS,
+   MISSES,
+   EVICTIONS,
+   MEMORY,
+   NUM_QUERIES
+};
+
+
+struct fs_cache_test {
+   struct pipe_screen *screen;
+   struct pipe_context *pipe;
+   void *rasterizer;
+   void *depth_stencil;
+   struct pipe_query *queries[NUM_QUERIES];
+};
+
+
+void
+write_tsv_header(FILE *fp)
+{
+   fprintf(fp,
+           "result\t"
+           "test\n");
+
+   fflush(fp);
+}
+
+
+/**
+ * A fragment shader writing a constant color, different for each i.
+ */
+static void *
+create_fs(struct pipe_context *pipe, unsigned i)
+{
+   struct ureg_program *ureg = ureg_create(PIPE_SHADER_FRAGMENT);
+   struct ureg_dst out = ureg_DECL_output(ureg, TGSI_SEMANTIC_COLOR, 0);
+
+   ureg_MOV(ureg, out, ureg_imm4f(ureg, (float)i, 0.0f, 0.0f, 1.0f));
+   ureg_END(ureg);
+
+   return ureg_create_shader_and_destroy(ureg, pipe);
+}
+
+
+/**
+ * Bind the shader and look up or create its variant, as a draw would.
+ * Returns the llvmpipe shader, which the draw module may have wrapped.
+ */
+static struct lp_fragment_shader *
+use_fs(struct fs_cache_test *t, void *fs)
+{
+   struct llvmpipe_context *lp = llvmpipe_context(t->pipe);
+
+   t->pipe->bind_fs_state(t->pipe, fs);
+   llvmpipe_update_fs(lp);
+   return lp->fs;
+}
+
+
+static void
+begin_queries(struct fs_cache_test *t)
+{
+   unsigned i;
+
+   for (i = 0; i < NUM_QUERIES; i++)
+      t->pipe->begin_query(t->pipe, t->queries[i]);
+}
+
+
+static void
+end_queries(struct fs_cache_test *t, uint64_t results[NUM_QUERIES])
+{
+   unsigned i;
+
+   for (i = 0; i < NUM_QUERIES; i++) {
+      union pipe_query_result result;
+
+      t->pipe->end_query(t->pipe, t->queries[i]);
+      if (!t->pipe->get_query_result(t->pipe, t->queries[i], FALSE, &result))
+         result.u64 = ~0ULL;
+      results[i] = result.u64;
+   }
+}
+
+
+static boolean
+init_test(struct fs_cache_test *t)
+{
+   struct pipe_rasterizer_state rasterizer;
+   struct pipe_depth_stencil_alpha_state depth_stencil;
+   unsigned i;
+
+   memset(t, 0, sizeof *t);
+
+   /* Don't let variant keys from earlier runs be compiled ahead. */
+   setenv("MESA_GLSL_CACHE_DISABLE", "true", 1);
+
+   t->screen = llvmpipe_create_screen(null_sw_create());
+   if (!t->screen)
+      return FALSE;
+
+   t->pipe = t->screen->context_create(t->screen, NULL, 0);
+   if (!t->pipe)
+      return FALSE;
+
+   memset(&rasterizer, 0, sizeof rasterizer);
+   t->rasterizer = t->pipe->create_rasterizer_state(t->pipe, &rasterizer);
+   t->pipe->bind_rasterizer_state(t->pipe, t->rasterizer);
+
+   memset(&depth_stencil, 0, sizeof depth_stencil);
+   t->depth_stencil =
+      t->pipe->create_depth_stencil_alpha_state(t->pipe, &depth_stencil);
+   t->pipe->bind_depth_stencil_alpha_state(t->pipe, t->depth_stencil);
+
+   for (i = 0; i < NUM_QUERIES; i++) {
+      t->queries[i] = t->pipe->create_query(t->pipe,
+                                            LP_QUERY_FS_VARIANT_HITS + i, 0);
+      if (!t->queries[i])
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+static void
+fini_test(struct fs_cache_test *t)
+{
+   unsigned i;
+
+   if (t->pipe) {
+      for (i = 0; i < NUM_QUERIES; i++) {
+         if (t->queries[i])
+            t->pipe->destroy_query(t->pipe, t->queries[i]);
+      }
+      t->pipe->bind_rasterizer_state(t->pipe, NULL);
+      t->pipe->delete_rasterizer_state(t->pipe, t->rasterizer);
+      t->pipe->bind_depth_stencil_alpha_state(t->pipe, NULL);
+      t->pipe->delete_depth_stencil_alpha_state(t->pipe, t->depth_stencil);
+      t->pipe->destroy(t->pipe);
+   }
+   if (t->screen)
+      t->screen->destroy(t->screen);
+}
+
+
+/**
+ * Check that the driver queries are listed in a perfmon group.
+ */
+static boolean
+test_query_info(unsigned verbose, FILE *fp, struct fs_cache_test *t)
+{
+   struct pipe_screen *screen = t->screen;
+   struct pipe_driver_query_group_info group;
+   struct pipe_driver_query_info info;
+   int num_queries;
+   int i;
+   boolean success = TRUE;
+
+   num_queries = screen->get_driver_query_info(screen, 0, NULL);
+   if (num_queries != NUM_QUERIES ||
+       screen->get_driver_query_group_info(screen, 0, NULL) != 1 ||
+       !screen->get_driver_query_group_info(screen, 0, &group) ||
+       group.num_queries != num_queries)
+      success = FALSE;
+
+   for (i = 0; i < num_queries; i++) {
+      if (!screen->get_driver_query_info(screen, i, &info) ||
+          info.query_type != LP_QUERY_FS_VARIANT_HITS + i ||
+          info.group_id != 0)
+         success = FALSE;
+   }
+
+   if (verbose || !success)
+      fprintf(stderr, "%s: query info\n", success ? "PASS" : "FAIL");
+   if (fp)
+      fprintf(fp, "%s\tquery info\n", success ? "1" : "0");
+
+   return success;
+}
+
+
+/**
+ * Check the counters for a miss, a hit and the destruction of a shader.
+ */
+static boolean
+test_accounting(unsigned verbose, FILE *fp, struct fs_cache_test *t)
+{
+   struct llvmpipe_context *lp = llvmpipe_context(t->pipe);
+   struct lp_fragment_shader *shader;
+   uint64_t results[NUM_QUERIES];
+   uint64_t size;
+   void *fs;
+   boolean success = TRUE;
+
+   fs = create_fs(t->pipe, 0);
+
+   begin_queries(t);
+   shader = use_fs(t, fs);
+   end_queries(t, results);
+
+   size = lp->fs_variants_size;
+   if (results[HITS] != 0 || results[MISSES] != 1 ||
+       results[EVICTIONS] != 0 || results[MEMORY] != size ||
+       size == 0 || lp->nr_fs_variants != 1 || shader->variants_cached != 1)
+      success = FALSE;
+
+   begin_queries(t);
+   use_fs(t, fs);
+   end_queries(t, results);
+
+   if (results[HITS] != 1 || results[MISSES] != 0 ||
+       results[MEMORY] != size || lp->nr_fs_variants != 1)
+      success = FALSE;
+
+   t->pipe->bind_fs_state(t->pipe, NULL);
+   t->pipe->delete_fs_state(t->pipe, fs);
+
+   begin_queries(t);
+   end_queries(t, results);
+
+   if (results[MEMORY] != 0 || lp->nr_fs_variants != 0 ||
+       lp->nr_fs_instrs != 0)
+      success = FALSE;
+
+   if (verbose || !success)
+      fprintf(stderr, "%s: accounting, variant size %" PRIu64 " bytes\n",
+              success ? "PASS" : "FAIL", size);
+   if (fp)
+      fprintf(fp, "%s\taccounting\n", success ? "1" : "0");
+
+   return success;
+}
+
+
+/**
+ * Fill the cache with one variant for each of many shaders, touching the
+ * first shader after every miss.  The first miss beyond a limit must evict
+ * the least recently used variants, but not the first shader's, down to the
+ * low-water mark, and the following miss must not evict anything.
+ */
+static boolean
+test_eviction(unsigned verbose, FILE *fp, struct fs_cache_test *t)
+{
+   const unsigned max_shaders = LP_MAX_SHADER_VARIANTS + 2;
+   struct llvmpipe_context *lp = llvmpipe_context(t->pipe);
+   struct lp_fragment_shader **shaders;
+   struct lp_fragment_shader_variant *variant;
+   void **fs;
+   uint64_t results[NUM_QUERIES];
+   unsigned num_shaders = 0;
+   unsigned evicted = 0;
+   unsigned cached = 0;
+   unsigned i;
+   boolean success = TRUE;
+
+   fs = CALLOC(max_shaders, sizeof *fs);
+   shaders = CALLOC(max_shaders, sizeof *shaders);
+   if (!fs || !shaders) {
+      FREE(fs);
+      FREE(shaders);
+      return FALSE;
+   }
+
+   begin_queries(t);
+
+   while (num_shaders < max_shaders) {
+      cached = lp->nr_fs_variants;
+
+      fs[num_shaders] = create_fs(t->pipe, num_shaders);
+      shaders[num_shaders] = use_fs(t, fs[num_shaders]);
+      num_shaders++;
+      use_fs(t, fs[0]);
+
+      if (lp->fs_variant_stats.evictions)
+         break;
+   }
+
+   evicted = lp->fs_variant_stats.evictions;
+   variant = first_elem(&shaders[num_shaders - 1]->variants)->base;
+
+   /* Without the variant created after the eviction, the cache must be
+    * under the low-water mark of every limit.
+    */
+   if (!evicted ||
+       lp->nr_fs_variants != cached - evicted + 1 ||
+       lp->nr_fs_variants - 1 >= LP_MAX_SHADER_VARIANTS / 16 *
+                                 LP_SHADER_VARIANT_LOW_WATER ||
+       lp->nr_fs_instrs - variant->nr_instrs >=
+          LP_MAX_SHADER_INSTRUCTIONS / 16 * LP_SHADER_VARIANT_LOW_WATER ||
+       lp->fs_variants_size - variant->size >=
+          (uint64_t)LP_MAX_SHADER_VARIANT_MEMORY / 16 *
+          LP_SHADER_VARIANT_LOW_WATER)
+      success = FALSE;
+
+   /* The least recently used shaders lost their variants, in order. */
+   if (shaders[0]->variants_cached != 1)
+      success = FALSE;
+   for (i = 1; i < num_shaders; i++) {
+      if (shaders[i]->variants_cached != (i > evicted ? 1 : 0))
+         success = FALSE;
+   }
+
+   /* The next miss must not evict again. */
+   fs[num_shaders] = create_fs(t->pipe, num_shaders);
+   shaders[num_shaders] = use_fs(t, fs[num_shaders]);
+   num_shaders++;
+
+   end_queries(t, results);
+
+   if (results[EVICTIONS] != evicted ||
+       results[MISSES] != num_shaders ||
+       results[HITS] != num_shaders - 1 ||
+       results[MEMORY] != lp->fs_variants_size)
+      success = FALSE;
+
+   t->pipe->bind_fs_state(t->pipe, NULL);
+   for (i = 0; i < num_shaders; i++)
+      t->pipe->delete_fs_state(t->pipe, fs[i]);
+   FREE(shaders);
+   FREE(fs);
+
+   if (lp->nr_fs_variants != 0 || lp->fs_variants_size != 0)
+      success = FALSE;
+
+   if (verbose || !success)
+      fprintf(stderr, "%s: eviction, %u of %u variants evicted\n",
+              success ? "PASS" : "FAIL", evicted, cached);
+   if (fp)
+      fprintf(fp, "%s\teviction\n", success ? "1" : "0");
+
+   return success;
+}
+
+
+boolean
+test_all(unsigned verbose, FILE *fp)
+{
+   struct fs_cache_test t;
+   boolean success = TRUE;
+
+   if (!init_test(&t)) {
+      fprintf(stderr, "FAIL: could not create an llvmpipe context\n");
+      fini_test(&t);
+      return FALSE;
+   }
+
+   success = test_query_info(verbose, fp, &t) && success;
+   success = test_accounting(verbose, fp, &t) && success;
+   success = test_eviction(verbose, fp, &t) && success;
+
+   fini_test(&t);
+
+   return success;
+}
+
+
+boolean
+test_some(unsigned verbose, FILE *fp,
+          unsigned long n)
+{
+   return test_all(verbose, fp);
+}
+
+
+boolean
+test_single(unsigned verbose, FILE *fp)
+{
+   printf("no test_single()");
+   return TRUE;
+}
@@ -332,7 +332,7 @@ llvmpipe_resource_destroy(struct pipe_screen *pscreen,
    }
    else if (llvmpipe_resource_is_texture(pt)) {
       /* free linear image data */
-      if (lpr->tex_data) {
+      if (lpr->tex_data && !lpr->userBuffer) {
          align_free(lpr->tex_data);
          lpr->tex_data = NULL;
       }
@@ -491,6 +491,90 @@ no_lpr:
 }
 
 
+/**
+ * Wrap memory provided by the caller in a buffer or a single-level 2D
+ * texture.  For textures the memory must hold the layout
+ * llvmpipe_texture_layout() computes for the template, i.e. rows of
+ * lpr->row_stride[0] bytes.
+ */
+static struct pipe_resource *
+llvmpipe_resource_from_user_memory(struct pipe_screen *_screen,
+                                   const struct pipe_resource *resource,
+                                   void *user_memory)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(_screen);
+   struct llvmpipe_resource *lpr;
+
+   if (resource->target == PIPE_BUFFER) {
+      /* Buffers created by llvmpipe_resource_create() get some padding for
+       * rendering to them, which only applies to graphics, hence
+       * PIPE_CAP_RESOURCE_FROM_USER_MEMORY_COMPUTE_ONLY.
+       */
+      if ((uintptr_t)user_memory % 16)
+         return NULL;
+
+      lpr = CALLOC_STRUCT(llvmpipe_resource);
+      if (!lpr)
+         return NULL;
+
+      lpr->base = *resource;
+      pipe_reference_init(&lpr->base.reference, 1);
+      lpr->base.screen = _screen;
+      lpr->data = user_memory;
+      lpr->userBuffer = TRUE;
+      lpr->row_stride[0] = resource->width0;
+      lpr->id = id_counter++;
+
+#ifdef DEBUG
+      insert_at_tail(&resource_list, lpr);
+#endif
+
+      return &lpr->base;
+   }
+
+   if ((resource->target != PIPE_TEXTURE_2D &&
+        resource->target != PIPE_TEXTURE_RECT) ||
+       resource->last_level > 0 ||
+       resource->nr_samples > 1 ||
+       util_format_is_compressed(resource->format) ||
+       (resource->bind & (PIPE_BIND_DISPLAY_TARGET |
+                          PIPE_BIND_SCANOUT |
+                          PIPE_BIND_SHARED)))
+      return NULL;
+
+   /* Rendering reads and writes whole LP_RASTER_BLOCK_SIZE blocks, with
+    * up to 16 byte aligned accesses.  Padding rows below the image would
+    * lie outside of the user memory.
+    */
+   if (resource->height0 % LP_RASTER_BLOCK_SIZE ||
+       (uintptr_t)user_memory % 16)
+      return NULL;
+
+   lpr = CALLOC_STRUCT(llvmpipe_resource);
+   if (!lpr)
+      return NULL;
+
+   lpr->base = *resource;
+   pipe_reference_init(&lpr->base.reference, 1);
+   lpr->base.screen = _screen;
+
+   if (!llvmpipe_texture_layout(screen, lpr, false)) {
+      FREE(lpr);
+      return NULL;
+   }
+
+   lpr->tex_data = user_memory;
+   lpr->userBuffer = TRUE;
+   lpr->id = id_counter++;
+
+#ifdef DEBUG
+   insert_at_tail(&resource_list, lpr);
+#endif
+
+   return &lpr->base;
+}
+
+
 static bool
 llvmpipe_resource_get_handle(struct pipe_screen *screen,
                              struct pipe_context *ctx,
@@ -835,6 +919,7 @@ llvmpipe_init_screen_resource_funcs(struct pipe_screen *screen)
    screen->resource_destroy = llvmpipe_resource_destroy;
    screen->resource_from_handle = llvmpipe_resource_from_handle;
    screen->resource_get_handle = llvmpipe_resource_get_handle;
+   screen->resource_from_user_memory = llvmpipe_resource_from_user_memory;
    screen->can_create_resource = llvmpipe_can_create_resource;
 }
 
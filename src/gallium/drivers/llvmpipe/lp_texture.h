@@ -85,7 +85,7 @@ struct llvmpipe_resource
     */
    void *data;
 
-   boolean userBuffer;  /** Is this a user-space buffer? */
+   boolean userBuffer;  /** Is data/tex_data user memory we don't own? */
    unsigned timestamp;
 
    unsigned id;  /**< temporary, for debugging */
@@ -35,6 +35,7 @@
 #include "util/u_inlines.h"
 #include "util/format/u_format.h"
 #include "util/u_memory.h"
+#include "util/u_parallel.h"
 #include "util/u_tile.h"
 #include "sp_tile_cache.h"
 
@@ -333,29 +334,29 @@ clear_tile(struct softpipe_cached_tile *tile,
 }
 
 
+struct flush_clear_job {
+   struct softpipe_tile_cache *tc;
+   int layer;
+};
+
 /**
- * Actually clear the tiles which were flagged as being in a clear state.
+ * Push the scratch tile to the flagged positions of a band of tile rows.
+ * Every tile covers its own region of the surface, so bands can be
+ * written concurrently.
  */
 static void
-sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
+sp_tile_cache_flush_clear_rows(void *data, unsigned first_row,
+                               unsigned num_rows)
 {
+   const struct flush_clear_job *job = data;
+   struct softpipe_tile_cache *tc = job->tc;
+   const int layer = job->layer;
    struct pipe_transfer *pt = tc->transfer[layer];
-   const uint w = tc->transfer[layer]->box.width;
-   const uint h = tc->transfer[layer]->box.height;
+   const uint w = pt->box.width;
    uint x, y;
-   uint numCleared = 0;
 
-   assert(pt->resource);
-
-   /* clear the scratch tile to the clear value */
-   if (tc->depth_stencil) {
-      clear_tile(tc->tile, pt->resource->format, tc->clear_val);
-   } else {
-      clear_tile_rgba(tc->tile, pt->resource->format, &tc->clear_color);
-   }
-
-   /* push the tile to all positions marked as clear */
-   for (y = 0; y < h; y += TILE_SIZE) {
+   for (y = first_row * TILE_SIZE;
+        y < (first_row + num_rows) * TILE_SIZE; y += TILE_SIZE) {
       for (x = 0; x < w; x += TILE_SIZE) {
          union tile_address addr = tile_address(x, y, layer);
 
@@ -372,15 +373,33 @@ sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
                                   tc->surface->format,
                                   tc->tile->data.color);
             }
-            numCleared++;
          }
       }
    }
+}
+
+/**
+ * Actually clear the tiles which were flagged as being in a clear state.
+ */
+static void
+sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
+{
+   struct pipe_transfer *pt = tc->transfer[layer];
+   const uint h = tc->transfer[layer]->box.height;
+   struct flush_clear_job job = { tc, layer };
 
+   assert(pt->resource);
 
-#if 0
-   debug_printf("num cleared: %u\n", numCleared);
-#endif
+   /* clear the scratch tile to the clear value */
+   if (tc->depth_stencil) {
+      clear_tile(tc->tile, pt->resource->format, tc->clear_val);
+   } else {
+      clear_tile_rgba(tc->tile, pt->resource->format, &tc->clear_color);
+   }
+
+   /* push the tile to all positions marked as clear */
+   util_parallel_rows(DIV_ROUND_UP(h, TILE_SIZE), 1,
+                      sp_tile_cache_flush_clear_rows, &job);
 }
 
 static void
@@ -407,6 +426,18 @@ sp_flush_tile(struct softpipe_tile_cache* tc, unsigned pos)
    }
 }
 
+static void
+sp_flush_tile_rows(void *data, unsigned first, unsigned count)
+{
+   struct softpipe_tile_cache *tc = data;
+   unsigned pos;
+
+   for (pos = first; pos < first + count; pos++) {
+      if (tc->entries[pos])
+         sp_flush_tile(tc, pos);
+   }
+}
+
 /**
  * Flush the tile cache: write all dirty tiles back to the transfer.
  * any tiles "flagged" as cleared will be "really" cleared.
@@ -425,10 +456,13 @@ sp_flush_tile_cache(struct softpipe_tile_cache *tc)
             assert(tc->tile_addrs[pos].bits.invalid);
             continue;
          }
-         sp_flush_tile(tc, pos);
          ++inuse;
       }
 
+      /* The cached tiles are all different, write them back in parallel. */
+      util_parallel_rows(ARRAY_SIZE(tc->entries), 4,
+                         sp_flush_tile_rows, tc);
+
       if (!tc->tile)
          tc->tile = sp_alloc_tile(tc);
 
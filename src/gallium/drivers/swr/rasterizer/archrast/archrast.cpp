@@ -188,24 +188,24 @@ namespace ArchRast
         virtual void Handle(const EarlyDepthStencilInfoSingleSample& event)
         {
             // earlyZ test compute
-            mDSSingleSample.earlyZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSSingleSample.earlyZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSSingleSample.earlyZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // earlyStencil test compute
-            mDSSingleSample.earlyStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSSingleSample.earlyStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSSingleSample.earlyStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             // earlyZ test single and multi sample
-            mDSCombined.earlyZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSCombined.earlyZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSCombined.earlyZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // earlyStencil test single and multi sample
-            mDSCombined.earlyStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSCombined.earlyStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSCombined.earlyStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             mNeedFlush = true;
         }
@@ -213,24 +213,24 @@ namespace ArchRast
         virtual void Handle(const EarlyDepthStencilInfoSampleRate& event)
         {
             // earlyZ test compute
-            mDSSampleRate.earlyZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSSampleRate.earlyZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSSampleRate.earlyZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // earlyStencil test compute
-            mDSSampleRate.earlyStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSSampleRate.earlyStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSSampleRate.earlyStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             // earlyZ test single and multi sample
-            mDSCombined.earlyZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSCombined.earlyZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSCombined.earlyZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // earlyStencil test single and multi sample
-            mDSCombined.earlyStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSCombined.earlyStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSCombined.earlyStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             mNeedFlush = true;
         }
@@ -238,38 +238,38 @@ namespace ArchRast
         virtual void Handle(const EarlyDepthStencilInfoNullPS& event)
         {
             // earlyZ test compute
-            mDSNullPS.earlyZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSNullPS.earlyZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSNullPS.earlyZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // earlyStencil test compute
-            mDSNullPS.earlyStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSNullPS.earlyStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSNullPS.earlyStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
             mNeedFlush = true;
         }
 
         virtual void Handle(const LateDepthStencilInfoSingleSample& event)
         {
             // lateZ test compute
-            mDSSingleSample.lateZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSSingleSample.lateZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSSingleSample.lateZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // lateStencil test compute
-            mDSSingleSample.lateStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSSingleSample.lateStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSSingleSample.lateStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             // lateZ test single and multi sample
-            mDSCombined.lateZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSCombined.lateZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSCombined.lateZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // lateStencil test single and multi sample
-            mDSCombined.lateStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSCombined.lateStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSCombined.lateStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             mNeedFlush = true;
         }
@@ -277,24 +277,24 @@ namespace ArchRast
         virtual void Handle(const LateDepthStencilInfoSampleRate& event)
         {
             // lateZ test compute
-            mDSSampleRate.lateZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSSampleRate.lateZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSSampleRate.lateZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // lateStencil test compute
-            mDSSampleRate.lateStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSSampleRate.lateStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSSampleRate.lateStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             // lateZ test single and multi sample
-            mDSCombined.lateZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSCombined.lateZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSCombined.lateZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // lateStencil test single and multi sample
-            mDSCombined.lateStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSCombined.lateStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSCombined.lateStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
 
             mNeedFlush = true;
         }
@@ -302,14 +302,14 @@ namespace ArchRast
         virtual void Handle(const LateDepthStencilInfoNullPS& event)
         {
             // lateZ test compute
-            mDSNullPS.lateZTestPassCount += _mm_popcnt_u32(event.data.depthPassMask);
+            mDSNullPS.lateZTestPassCount += _mm_popcnt_u64(event.data.depthPassMask);
             mDSNullPS.lateZTestFailCount +=
-                _mm_popcnt_u32((!event.data.depthPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.depthPassMask) & event.data.coverageMask);
 
             // lateStencil test compute
-            mDSNullPS.lateStencilTestPassCount += _mm_popcnt_u32(event.data.stencilPassMask);
+            mDSNullPS.lateStencilTestPassCount += _mm_popcnt_u64(event.data.stencilPassMask);
             mDSNullPS.lateStencilTestFailCount +=
-                _mm_popcnt_u32((!event.data.stencilPassMask) & event.data.coverageMask);
+                _mm_popcnt_u64((!event.data.stencilPassMask) & event.data.coverageMask);
             mNeedFlush = true;
         }
 
@@ -318,7 +318,7 @@ namespace ArchRast
             // earlyZ test compute
             mDSPixelRate.earlyZTestPassCount += event.data.depthPassCount;
             mDSPixelRate.earlyZTestFailCount +=
-                (_mm_popcnt_u32(event.data.activeLanes) - event.data.depthPassCount);
+                (_mm_popcnt_u64(event.data.activeLanes) - event.data.depthPassCount);
             mNeedFlush = true;
         }
 
@@ -328,7 +328,7 @@ namespace ArchRast
             // lateZ test compute
             mDSPixelRate.lateZTestPassCount += event.data.depthPassCount;
             mDSPixelRate.lateZTestFailCount +=
-                (_mm_popcnt_u32(event.data.activeLanes) - event.data.depthPassCount);
+                (_mm_popcnt_u64(event.data.activeLanes) - event.data.depthPassCount);
             mNeedFlush = true;
         }
 
@@ -604,9 +604,9 @@ namespace ArchRast
 
         virtual void Handle(const CullInfoEvent& event)
         {
-            mCullStats.degeneratePrimCount += _mm_popcnt_u32(
+            mCullStats.degeneratePrimCount += _mm_popcnt_u64(
                 event.data.validMask ^ (event.data.validMask & ~event.data.degeneratePrimMask));
-            mCullStats.backfacePrimCount += _mm_popcnt_u32(
+            mCullStats.backfacePrimCount += _mm_popcnt_u64(
                 event.data.validMask ^ (event.data.validMask & ~event.data.backfacePrimMask));
         }
 
@@ -636,13 +636,257 @@ namespace ArchRast
 
     };
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Live export of the ArchRast counters. Worker threads publish
+    ///        their share of each draw; any thread can sample the running
+    ///        totals, or read the latest per draw samples back from a fixed
+    ///        size ring, while rendering carries on.
+    class MetricsStream
+    {
+    public:
+        static const uint32_t RING_SIZE = 256;
+
+        MetricsStream() : mHead(0)
+        {
+            for (auto& total : mTotals)
+            {
+                total.store(0, std::memory_order_relaxed);
+            }
+            for (auto& slot : mRing)
+            {
+                slot.seq.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void Publish(uint32_t drawId, const uint64_t (&counters)[SWR_AR_METRIC_COUNT])
+        {
+            for (uint32_t i = 0; i < SWR_AR_METRIC_COUNT; ++i)
+            {
+                mTotals[i].fetch_add(counters[i], std::memory_order_relaxed);
+            }
+
+            // Each slot carries a sequence word: odd while a writer owns it,
+            // 2 * seq + 2 once sample seq is complete.
+            uint64_t seq  = mHead.fetch_add(1, std::memory_order_relaxed);
+            Slot&    slot = mRing[seq % RING_SIZE];
+            uint64_t cur  = slot.seq.load(std::memory_order_relaxed);
+            do
+            {
+                while (cur & 1)
+                {
+                    cur = slot.seq.load(std::memory_order_relaxed);
+                }
+            } while (!slot.seq.compare_exchange_weak(cur, 2 * seq + 1, std::memory_order_acquire));
+
+            slot.drawId.store(drawId, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < SWR_AR_METRIC_COUNT; ++i)
+            {
+                slot.counters[i].store(counters[i], std::memory_order_relaxed);
+            }
+            slot.seq.store(2 * seq + 2, std::memory_order_release);
+        }
+
+        void GetTotals(uint64_t* pTotals) const
+        {
+            for (uint32_t i = 0; i < SWR_AR_METRIC_COUNT; ++i)
+            {
+                pTotals[i] = mTotals[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        uint32_t Read(uint64_t* pCursor, SWR_AR_SAMPLE* pSamples, uint32_t maxSamples) const
+        {
+            uint64_t head = mHead.load(std::memory_order_acquire);
+            uint64_t seq  = *pCursor;
+            uint32_t numSamples = 0;
+
+            // Anything older than the ring is gone.
+            if (head > RING_SIZE && seq < head - RING_SIZE)
+            {
+                seq = head - RING_SIZE;
+            }
+
+            for (; seq < head && numSamples < maxSamples; ++seq)
+            {
+                const Slot& slot = mRing[seq % RING_SIZE];
+                uint64_t    cur  = slot.seq.load(std::memory_order_acquire);
+
+                // Still being written: stop here and pick it up next time.
+                if (cur < 2 * seq + 2)
+                {
+                    break;
+                }
+
+                SWR_AR_SAMPLE& sample = pSamples[numSamples];
+                sample.sequence       = seq;
+                sample.drawId         = slot.drawId.load(std::memory_order_relaxed);
+                for (uint32_t i = 0; i < SWR_AR_METRIC_COUNT; ++i)
+                {
+                    sample.counters[i] = slot.counters[i].load(std::memory_order_relaxed);
+                }
+
+                // Only keep the copy if no newer sample took the slot meanwhile.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (cur == 2 * seq + 2 && slot.seq.load(std::memory_order_relaxed) == cur)
+                {
+                    numSamples++;
+                }
+            }
+
+            *pCursor = seq;
+            return numSamples;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint64_t> seq;
+            std::atomic<uint32_t> drawId;
+            std::atomic<uint64_t> counters[SWR_AR_METRIC_COUNT];
+        };
+
+        std::atomic<uint64_t> mTotals[SWR_AR_METRIC_COUNT];
+        std::atomic<uint64_t> mHead;
+        Slot                  mRing[RING_SIZE];
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Event handler that feeds the live metrics stream. There is one
+    ///        per worker thread, its counts are published whenever the
+    ///        worker is done with its part of a draw.
+    class EventHandlerMetrics : public EventHandler
+    {
+    public:
+        EventHandlerMetrics(MetricsStream* pStream) : mpStream(pStream), mNeedPublish(false)
+        {
+            memset(mCounters, 0, sizeof(mCounters));
+        }
+
+        virtual void Handle(const EarlyDepthStencilInfoSingleSample& event)
+        {
+            EarlyDepthStencil(
+                event.data.depthPassMask, event.data.stencilPassMask, event.data.coverageMask);
+        }
+
+        virtual void Handle(const EarlyDepthStencilInfoSampleRate& event)
+        {
+            EarlyDepthStencil(
+                event.data.depthPassMask, event.data.stencilPassMask, event.data.coverageMask);
+        }
+
+        virtual void Handle(const EarlyDepthStencilInfoNullPS& event)
+        {
+            EarlyDepthStencil(
+                event.data.depthPassMask, event.data.stencilPassMask, event.data.coverageMask);
+        }
+
+        virtual void Handle(const LateDepthStencilInfoSingleSample& event)
+        {
+            LateDepthStencil(
+                event.data.depthPassMask, event.data.stencilPassMask, event.data.coverageMask);
+        }
+
+        virtual void Handle(const LateDepthStencilInfoSampleRate& event)
+        {
+            LateDepthStencil(
+                event.data.depthPassMask, event.data.stencilPassMask, event.data.coverageMask);
+        }
+
+        virtual void Handle(const LateDepthStencilInfoNullPS& event)
+        {
+            LateDepthStencil(
+                event.data.depthPassMask, event.data.stencilPassMask, event.data.coverageMask);
+        }
+
+        virtual void Handle(const EarlyDepthInfoPixelRate& event)
+        {
+            mCounters[SWR_AR_METRIC_EARLY_Z_PASS] += event.data.depthPassCount;
+            mCounters[SWR_AR_METRIC_EARLY_Z_FAIL] +=
+                _mm_popcnt_u64(event.data.activeLanes) - event.data.depthPassCount;
+            mNeedPublish = true;
+        }
+
+        virtual void Handle(const LateDepthInfoPixelRate& event)
+        {
+            mCounters[SWR_AR_METRIC_LATE_Z_PASS] += event.data.depthPassCount;
+            mCounters[SWR_AR_METRIC_LATE_Z_FAIL] +=
+                _mm_popcnt_u64(event.data.activeLanes) - event.data.depthPassCount;
+            mNeedPublish = true;
+        }
+
+        virtual void Handle(const ClipInfoEvent& event)
+        {
+            mCounters[SWR_AR_METRIC_CLIP_MUST_CLIP] += _mm_popcnt_u32(event.data.clipMask);
+            mCounters[SWR_AR_METRIC_CLIP_TRIVIAL_REJECT] +=
+                event.data.numInvocations - _mm_popcnt_u32(event.data.validMask);
+            mCounters[SWR_AR_METRIC_CLIP_TRIVIAL_ACCEPT] +=
+                _mm_popcnt_u32(event.data.validMask & ~event.data.clipMask);
+            mNeedPublish = true;
+        }
+
+        virtual void Handle(const CullInfoEvent& event)
+        {
+            mCounters[SWR_AR_METRIC_CULL_DEGENERATE] +=
+                _mm_popcnt_u64(event.data.validMask & event.data.degeneratePrimMask);
+            mCounters[SWR_AR_METRIC_CULL_BACKFACE] +=
+                _mm_popcnt_u64(event.data.validMask & event.data.backfacePrimMask);
+            mNeedPublish = true;
+        }
+
+        virtual void Handle(const RasterTileCount& event)
+        {
+            mCounters[SWR_AR_METRIC_RASTER_TILES] += event.data.rasterTiles;
+            mNeedPublish = true;
+        }
+
+        virtual void Handle(const FrontendDrawEndEvent& event) { Publish(event.data.drawId); }
+
+        virtual void FlushDraw(uint32_t drawId) { Publish(drawId); }
+
+    private:
+        void EarlyDepthStencil(uint64_t depthPassMask, uint64_t stencilPassMask, uint64_t coverageMask)
+        {
+            mCounters[SWR_AR_METRIC_EARLY_Z_PASS] += _mm_popcnt_u64(depthPassMask);
+            mCounters[SWR_AR_METRIC_EARLY_Z_FAIL] += _mm_popcnt_u64(~depthPassMask & coverageMask);
+            mCounters[SWR_AR_METRIC_EARLY_STENCIL_PASS] += _mm_popcnt_u64(stencilPassMask);
+            mCounters[SWR_AR_METRIC_EARLY_STENCIL_FAIL] +=
+                _mm_popcnt_u64(~stencilPassMask & coverageMask);
+            mNeedPublish = true;
+        }
+
+        void LateDepthStencil(uint64_t depthPassMask, uint64_t stencilPassMask, uint64_t coverageMask)
+        {
+            mCounters[SWR_AR_METRIC_LATE_Z_PASS] += _mm_popcnt_u64(depthPassMask);
+            mCounters[SWR_AR_METRIC_LATE_Z_FAIL] += _mm_popcnt_u64(~depthPassMask & coverageMask);
+            mCounters[SWR_AR_METRIC_LATE_STENCIL_PASS] += _mm_popcnt_u64(stencilPassMask);
+            mCounters[SWR_AR_METRIC_LATE_STENCIL_FAIL] +=
+                _mm_popcnt_u64(~stencilPassMask & coverageMask);
+            mNeedPublish = true;
+        }
+
+        void Publish(uint32_t drawId)
+        {
+            if (mNeedPublish == false)
+                return;
+
+            mpStream->Publish(drawId, mCounters);
+
+            memset(mCounters, 0, sizeof(mCounters));
+            mNeedPublish = false;
+        }
+
+        MetricsStream* mpStream;
+        bool           mNeedPublish;
+        uint64_t       mCounters[SWR_AR_METRIC_COUNT];
+    };
+
     static EventManager* FromHandle(HANDLE hThreadContext)
     {
         return reinterpret_cast<EventManager*>(hThreadContext);
     }
 
     // Construct an event manager and associate a handler with it.
-    HANDLE CreateThreadContext(AR_THREAD type)
+    HANDLE CreateThreadContext(AR_THREAD type, HANDLE hMetrics)
     {
         // Can we assume single threaded here?
         static std::atomic<uint32_t> counter(0);
@@ -652,23 +896,31 @@ namespace ArchRast
 
         if (pManager)
         {
-            EventHandlerFile* pHandler = nullptr;
-
-            if (type == AR_THREAD::API)
+            if (KNOB_AR_ENABLE_FILE_OUTPUT)
             {
-                pHandler = new EventHandlerApiStats(id);
-                pManager->Attach(pHandler);
-                pHandler->Handle(ThreadStartApiEvent());
+                EventHandlerFile* pHandler = nullptr;
+
+                if (type == AR_THREAD::API)
+                {
+                    pHandler = new EventHandlerApiStats(id);
+                    pManager->Attach(pHandler);
+                    pHandler->Handle(ThreadStartApiEvent());
+                }
+                else
+                {
+                    pHandler = new EventHandlerWorkerStats(id);
+                    pManager->Attach(pHandler);
+                    pHandler->Handle(ThreadStartWorkerEvent());
+                }
+
+                pHandler->MarkHeader();
             }
-            else
+
+            if (hMetrics != nullptr)
             {
-                pHandler = new EventHandlerWorkerStats(id);
-                pManager->Attach(pHandler);
-                pHandler->Handle(ThreadStartWorkerEvent());
+                pManager->Attach(new EventHandlerMetrics(reinterpret_cast<MetricsStream*>(hMetrics)));
             }
 
-            pHandler->MarkHeader();
-
             return pManager;
         }
 
@@ -684,6 +936,32 @@ namespace ArchRast
         delete pManager;
     }
 
+    HANDLE CreateMetricsStream() { return new MetricsStream(); }
+
+    void DestroyMetricsStream(HANDLE hMetrics)
+    {
+        delete reinterpret_cast<MetricsStream*>(hMetrics);
+    }
+
+    void GetMetrics(HANDLE hMetrics, uint64_t* pTotals)
+    {
+        MetricsStream* pStream = reinterpret_cast<MetricsStream*>(hMetrics);
+        SWR_ASSERT(pStream != nullptr);
+
+        pStream->GetTotals(pTotals);
+    }
+
+    uint32_t ReadMetrics(HANDLE         hMetrics,
+                         uint64_t*      pCursor,
+                         SWR_AR_SAMPLE* pSamples,
+                         uint32_t       maxSamples)
+    {
+        MetricsStream* pStream = reinterpret_cast<MetricsStream*>(hMetrics);
+        SWR_ASSERT(pStream != nullptr);
+
+        return pStream->Read(pCursor, pSamples, maxSamples);
+    }
+
     // Dispatch event for this thread.
     void Dispatch(HANDLE hThreadContext, const Event& event)
     {
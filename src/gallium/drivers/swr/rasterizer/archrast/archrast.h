@@ -39,9 +39,18 @@ namespace ArchRast
         WORKER = 1
     };
 
-    HANDLE CreateThreadContext(AR_THREAD type);
+    HANDLE CreateThreadContext(AR_THREAD type, HANDLE hMetrics = nullptr);
     void   DestroyThreadContext(HANDLE hThreadContext);
 
+    // Live metrics stream, fed by the worker thread contexts attached to it.
+    HANDLE   CreateMetricsStream();
+    void     DestroyMetricsStream(HANDLE hMetrics);
+    void     GetMetrics(HANDLE hMetrics, uint64_t* pTotals);
+    uint32_t ReadMetrics(HANDLE         hMetrics,
+                         uint64_t*      pCursor,
+                         SWR_AR_SAMPLE* pSamples,
+                         uint32_t       maxSamples);
+
     // Dispatch event for this thread.
     void Dispatch(HANDLE hThreadContext, const Event& event);
 
@@ -315,6 +315,15 @@ KNOBS = [
         'category'  : 'perf_adv',
     }],
 
+    ['AR_ENABLE_FILE_OUTPUT', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Write ArchRast events to per thread files.',
+                       '',
+                       'Disable to only feed the live metrics stream used by driver queries.'],
+        'category'  : 'archrast',
+    }],
+
     ['AR_ENABLE_PIPELINE_STATS', {
         'type'      : 'bool',
         'default'   : 'true',
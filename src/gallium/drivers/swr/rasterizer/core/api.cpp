@@ -165,6 +165,7 @@ HANDLE SwrCreateContext(SWR_CREATECONTEXT_INFO* pCreateInfo)
 
 #if defined(KNOB_ENABLE_AR)
     // Setup ArchRast thread contexts which includes +1 for API thread.
+    pContext->hArMetrics = ArchRast::CreateMetricsStream();
     pContext->pArContext = new HANDLE[pContext->NumWorkerThreads + 1];
     pContext->pArContext[pContext->NumWorkerThreads] =
         ArchRast::CreateThreadContext(ArchRast::AR_THREAD::API);
@@ -196,7 +197,8 @@ HANDLE SwrCreateContext(SWR_CREATECONTEXT_INFO* pCreateInfo)
 
 #if defined(KNOB_ENABLE_AR)
         // Initialize worker thread context for ArchRast.
-        pContext->pArContext[i] = ArchRast::CreateThreadContext(ArchRast::AR_THREAD::WORKER);
+        pContext->pArContext[i] =
+            ArchRast::CreateThreadContext(ArchRast::AR_THREAD::WORKER, pContext->hArMetrics);
 
         SWR_WORKER_DATA* pWorkerData = (SWR_WORKER_DATA*)pContext->threadPool.pThreadData[i].pWorkerPrivateData;
         pWorkerData->hArContext = pContext->pArContext[i];
@@ -454,6 +456,10 @@ void SwrDestroyContext(HANDLE hContext)
 #endif
     }
 
+#if defined(KNOB_ENABLE_AR)
+    ArchRast::DestroyMetricsStream(pContext->hArMetrics);
+#endif
+
 #if defined(KNOB_ENABLE_RDTSC)
     delete pContext->pBucketMgr;
 #endif
@@ -1719,6 +1725,45 @@ void SwrEnableStatsBE(HANDLE hContext, bool enable)
     pDC->pState->state.enableStatsBE = enable;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Reads the running totals of the ArchRast live metrics.
+/// @param hContext - Handle passed back from SwrCreateContext, or NULL to
+///                   only check whether the metrics are available.
+/// @param pTotals - Receives SWR_AR_METRIC_COUNT counters.
+bool SwrGetArchRastMetrics(HANDLE hContext, uint64_t* pTotals)
+{
+#if defined(KNOB_ENABLE_AR)
+    if (hContext)
+    {
+        SWR_CONTEXT* pContext = GetContext(hContext);
+        ArchRast::GetMetrics(pContext->hArMetrics, pTotals);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Reads per draw samples back from the ArchRast live metrics ring.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pCursor - In: sequence of the first sample wanted. Out: sequence
+///                  to pass in on the next call.
+/// @param pSamples - Receives up to maxSamples samples.
+/// @param maxSamples - Size of pSamples.
+uint32_t SwrReadArchRastSamples(HANDLE         hContext,
+                                uint64_t*      pCursor,
+                                SWR_AR_SAMPLE* pSamples,
+                                uint32_t       maxSamples)
+{
+#if defined(KNOB_ENABLE_AR)
+    SWR_CONTEXT* pContext = GetContext(hContext);
+    return ArchRast::ReadMetrics(pContext->hArMetrics, pCursor, pSamples, maxSamples);
+#else
+    return 0;
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Mark end of frame - used for performance profiling
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -1797,6 +1842,8 @@ void SwrGetInterface(SWR_INTERFACE& out_funcs)
     out_funcs.pfnSwrAllocDrawContextMemory = SwrAllocDrawContextMemory;
     out_funcs.pfnSwrEnableStatsFE          = SwrEnableStatsFE;
     out_funcs.pfnSwrEnableStatsBE          = SwrEnableStatsBE;
+    out_funcs.pfnSwrGetArchRastMetrics     = SwrGetArchRastMetrics;
+    out_funcs.pfnSwrReadArchRastSamples    = SwrReadArchRastSamples;
     out_funcs.pfnSwrEndFrame               = SwrEndFrame;
     out_funcs.pfnSwrInit                   = SwrInit;
 }
@@ -703,6 +703,30 @@ SWR_FUNC(void, SwrEnableStatsFE, HANDLE hContext, bool enable);
 /// @param enable - If true then counts are incremented.
 SWR_FUNC(void, SwrEnableStatsBE, HANDLE hContext, bool enable);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Reads the running totals of the ArchRast live metrics.
+/// @param hContext - Handle passed back from SwrCreateContext, or NULL to
+///                   only check whether the metrics are available.
+/// @param pTotals - Receives SWR_AR_METRIC_COUNT counters.
+/// @return false if SWR was built without ArchRast.
+SWR_FUNC(bool, SwrGetArchRastMetrics, HANDLE hContext, uint64_t* pTotals);
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Reads per draw samples back from the ArchRast live metrics ring.
+///        Samples that were overwritten before being read are skipped.
+/// @param hContext - Handle passed back from SwrCreateContext
+/// @param pCursor - In: sequence of the first sample wanted. Out: sequence
+///                  to pass in on the next call.
+/// @param pSamples - Receives up to maxSamples samples.
+/// @param maxSamples - Size of pSamples.
+/// @return Number of samples written to pSamples.
+SWR_FUNC(uint32_t,
+         SwrReadArchRastSamples,
+         HANDLE         hContext,
+         uint64_t*      pCursor,
+         SWR_AR_SAMPLE* pSamples,
+         uint32_t       maxSamples);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief Mark end of frame - used for performance profiling
 /// @param hContext - Handle passed back from SwrCreateContext
@@ -760,6 +784,8 @@ struct SWR_INTERFACE
     PFNSwrAllocDrawContextMemory pfnSwrAllocDrawContextMemory;
     PFNSwrEnableStatsFE          pfnSwrEnableStatsFE;
     PFNSwrEnableStatsBE          pfnSwrEnableStatsBE;
+    PFNSwrGetArchRastMetrics     pfnSwrGetArchRastMetrics;
+    PFNSwrReadArchRastSamples    pfnSwrReadArchRastSamples;
     PFNSwrEndFrame               pfnSwrEndFrame;
     PFNSwrInit                   pfnSwrInit;
 };
@@ -563,6 +563,9 @@ struct SWR_CONTEXT
     // ArchRast thread contexts.
     HANDLE* pArContext;
 
+    // ArchRast live metrics stream shared by the worker thread contexts.
+    HANDLE hArMetrics;
+
     // handle to external memory for worker datas to create memory contexts
     HANDLE hExternalMemory;
 
@@ -638,6 +638,44 @@ OSALIGNLINE(struct) SWR_STATS_FE
     uint64_t SoNumPrimsWritten[4];
 };
 
+//////////////////////////////////////////////////////////////////////////
+/// SWR_AR_METRIC
+///
+/// @brief Counters ArchRast publishes to its live metrics stream.
+/////////////////////////////////////////////////////////////////////////
+enum SWR_AR_METRIC
+{
+    SWR_AR_METRIC_EARLY_Z_PASS,
+    SWR_AR_METRIC_EARLY_Z_FAIL,
+    SWR_AR_METRIC_LATE_Z_PASS,
+    SWR_AR_METRIC_LATE_Z_FAIL,
+    SWR_AR_METRIC_EARLY_STENCIL_PASS,
+    SWR_AR_METRIC_EARLY_STENCIL_FAIL,
+    SWR_AR_METRIC_LATE_STENCIL_PASS,
+    SWR_AR_METRIC_LATE_STENCIL_FAIL,
+    SWR_AR_METRIC_CLIP_TRIVIAL_REJECT,
+    SWR_AR_METRIC_CLIP_TRIVIAL_ACCEPT,
+    SWR_AR_METRIC_CLIP_MUST_CLIP,
+    SWR_AR_METRIC_CULL_BACKFACE,
+    SWR_AR_METRIC_CULL_DEGENERATE,
+    SWR_AR_METRIC_RASTER_TILES,
+
+    SWR_AR_METRIC_COUNT
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// SWR_AR_SAMPLE
+///
+/// @brief One worker thread's share of a draw, as read back from the
+///        ArchRast live metrics stream.
+/////////////////////////////////////////////////////////////////////////
+struct SWR_AR_SAMPLE
+{
+    uint64_t sequence; // Position of the sample in the stream.
+    uint32_t drawId;
+    uint64_t counters[SWR_AR_METRIC_COUNT];
+};
+
     //////////////////////////////////////////////////////////////////////////
     /// STREAMOUT_BUFFERS
     /////////////////////////////////////////////////////////////////////////
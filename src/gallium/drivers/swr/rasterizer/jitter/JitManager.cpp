@@ -129,10 +129,7 @@ JitManager::JitManager(uint32_t simdWidth, const char* arch, const char* core) :
         mOptLevel = CodeGenOpt::Level(KNOB_JIT_OPTIMIZATION_LEVEL);
     }
 
-    if (KNOB_JIT_ENABLE_CACHE)
-    {
-        mCache.Init(this, mHostCpuName, mOptLevel);
-    }
+    mCache.Init(this, mHostCpuName, mOptLevel);
 
     SetupNewModule();
     mIsModuleFinalized = true;
@@ -194,7 +191,7 @@ void JitManager::CreateExecEngine(std::unique_ptr<Module> pModule)
                  .setMCPU(mHostCpuName)
                  .create();
 
-    if (KNOB_JIT_ENABLE_CACHE)
+    if (KNOB_JIT_ENABLE_CACHE || mCache.HasExternalCache())
     {
         mpExec->setObjectCache(&mCache);
     }
@@ -543,6 +540,17 @@ void JITCALL JitDestroyContext(HANDLE hJitContext)
         delete reinterpret_cast<JitManager*>(hJitContext);
     }
 }
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Store objects compiled by this context in a client cache.
+void JITCALL JitSetObjectCache(HANDLE            hJitContext,
+                               void*             pPrivate,
+                               PFN_JIT_CACHE_GET pfnGet,
+                               PFN_JIT_CACHE_PUT pfnPut)
+{
+    JitManager* pJitMgr = reinterpret_cast<JitManager*>(hJitContext);
+    pJitMgr->mCache.SetExternalCache(pPrivate, pfnGet, pfnPut);
+}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -616,7 +624,7 @@ private:
     char     m_Cpu[JC_STR_MAX_LEN]      = {};
 };
 
-static inline uint32_t ComputeModuleCRC(const llvm::Module* M)
+static inline std::string GetModuleBitcode(const llvm::Module* M)
 {
     std::string        bitcodeBuffer;
     raw_string_ostream bitcodeStream(bitcodeBuffer);
@@ -630,6 +638,13 @@ static inline uint32_t ComputeModuleCRC(const llvm::Module* M)
 
     bitcodeStream.flush();
 
+    return bitcodeBuffer;
+}
+
+static inline uint32_t ComputeModuleCRC(const llvm::Module* M)
+{
+    std::string bitcodeBuffer = GetModuleBitcode(M);
+
     return ComputeCRC(0, bitcodeBuffer.data(), bitcodeBuffer.size());
 }
 
@@ -697,6 +712,16 @@ void JitCache::notifyObjectCompiled(const llvm::Module* M, llvm::MemoryBufferRef
         return;
     }
 
+    if (mpfnCachePut)
+    {
+        mpfnCachePut(mpCachePrivate,
+                     mCurrentModuleKey.data(),
+                     mCurrentModuleKey.size(),
+                     Obj.getBufferStart(),
+                     Obj.getBufferSize());
+        return;
+    }
+
     if (!mModuleCacheDir.size())
     {
         SWR_INVALID("Unset module cache directory");
@@ -745,7 +770,35 @@ void JitCache::notifyObjectCompiled(const llvm::Module* M, llvm::MemoryBufferRef
 std::unique_ptr<llvm::MemoryBuffer> JitCache::getObject(const llvm::Module* M)
 {
     const std::string& moduleID = M->getModuleIdentifier();
-    mCurrentModuleCRC           = ComputeModuleCRC(M);
+
+    if (mpfnCacheGet)
+    {
+        if (!moduleID.length())
+        {
+            return nullptr;
+        }
+
+        // The object depends on the IR, the target CPU and the codegen level.
+        std::stringstream key;
+        key << moduleID << '\0' << mCpu << '\0' << (uint32_t)mOptLevel << '\0'
+            << GetModuleBitcode(M);
+        mCurrentModuleKey = key.str();
+
+        size_t objSize = 0;
+        void*  pObj    = mpfnCacheGet(
+            mpCachePrivate, mCurrentModuleKey.data(), mCurrentModuleKey.size(), &objSize);
+        if (!pObj)
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<llvm::MemoryBuffer> pBuf = llvm::MemoryBuffer::getMemBufferCopy(
+            llvm::StringRef((const char*)pObj, objSize), moduleID);
+        free(pObj);
+        return pBuf;
+    }
+
+    mCurrentModuleCRC = ComputeModuleCRC(M);
 
     if (!moduleID.length())
     {
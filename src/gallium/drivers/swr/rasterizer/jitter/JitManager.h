@@ -31,6 +31,7 @@
 
 #include "jit_pch.hpp"
 #include "common/isa.hpp"
+#include "jit_api.h"
 #include <llvm/IR/AssemblyAnnotationWriter.h>
 
 
@@ -112,6 +113,15 @@ public:
 
     const char* GetModuleCacheDir() { return mModuleCacheDir.c_str(); }
 
+    void SetExternalCache(void* pPrivate, PFN_JIT_CACHE_GET pfnGet, PFN_JIT_CACHE_PUT pfnPut)
+    {
+        mpCachePrivate = pPrivate;
+        mpfnCacheGet   = pfnGet;
+        mpfnCachePut   = pfnPut;
+    }
+
+    bool HasExternalCache() const { return mpfnCacheGet != nullptr; }
+
 private:
     std::string                 mCpu;
     llvm::SmallString<MAX_PATH> mCacheDir;
@@ -120,6 +130,12 @@ private:
     JitManager*                 mpJitMgr          = nullptr;
     llvm::CodeGenOpt::Level     mOptLevel         = llvm::CodeGenOpt::None;
 
+    // Client storage, replaces the cache directory when set.
+    void*             mpCachePrivate = nullptr;
+    PFN_JIT_CACHE_GET mpfnCacheGet   = nullptr;
+    PFN_JIT_CACHE_PUT mpfnCachePut   = nullptr;
+    std::string       mCurrentModuleKey;
+
     /// Calculate actual directory where module will be cached.
     /// This is always a subdirectory of mCacheDir.  Full absolute
     /// path name will be stored in mCurrentModuleCacheDir
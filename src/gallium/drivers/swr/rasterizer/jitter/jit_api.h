@@ -66,6 +66,18 @@ struct JIT_COMPILE_INPUT
 };
 
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Callbacks backing the JIT object cache with client storage.
+///        Lookups are keyed on the module bitcode, its name, the target
+///        CPU and the optimization level; the client hashes the key itself.
+///        Get returns a malloc'ed copy of the object, or NULL on a miss.
+typedef void*(JITCALL* PFN_JIT_CACHE_GET)(void*       pPrivate,
+                                          const void* pKey,
+                                          size_t      keySize,
+                                          size_t*     pObjSize);
+typedef void(JITCALL* PFN_JIT_CACHE_PUT)(
+    void* pPrivate, const void* pKey, size_t keySize, const void* pObj, size_t objSize);
+
 extern "C" {
 
 //////////////////////////////////////////////////////////////////////////
@@ -76,6 +88,17 @@ HANDLE JITCALL JitCreateContext(uint32_t targetSimdWidth, const char* arch, cons
 /// @brief Destroy JIT context.
 void JITCALL JitDestroyContext(HANDLE hJitContext);
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Store objects compiled by this context in a client cache.
+/// @param hJitContext - Jit Context
+/// @param pPrivate - Passed back to the callbacks
+/// @param pfnGet - Looks up a compiled object
+/// @param pfnPut - Stores a compiled object
+void JITCALL JitSetObjectCache(HANDLE            hJitContext,
+                               void*             pPrivate,
+                               PFN_JIT_CACHE_GET pfnGet,
+                               PFN_JIT_CACHE_PUT pfnPut);
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief JIT compile shader.
 /// @param hJitContext - Jit Context
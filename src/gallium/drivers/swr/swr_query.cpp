@@ -37,12 +37,103 @@ swr_query(struct pipe_query *p)
    return (struct swr_query *)p;
 }
 
+/* ArchRast live metrics, exposed as PIPE_QUERY_DRIVER_SPECIFIC + metric */
+static const char *swr_ar_metric_names[SWR_AR_METRIC_COUNT] = {
+   "early-z-pass",
+   "early-z-fail",
+   "late-z-pass",
+   "late-z-fail",
+   "early-stencil-pass",
+   "early-stencil-fail",
+   "late-stencil-pass",
+   "late-stencil-fail",
+   "clip-trivial-reject",
+   "clip-trivial-accept",
+   "clip-must-clip",
+   "cull-backface",
+   "cull-degenerate",
+   "raster-tiles",
+};
+
+static bool
+swr_is_ar_metric_query(unsigned type)
+{
+   return type >= PIPE_QUERY_DRIVER_SPECIFIC &&
+          type < PIPE_QUERY_DRIVER_SPECIFIC + SWR_AR_METRIC_COUNT;
+}
+
+static uint64_t
+swr_read_ar_metric(struct swr_context *ctx, unsigned type)
+{
+   uint64_t totals[SWR_AR_METRIC_COUNT];
+
+   ctx->api.pfnSwrGetArchRastMetrics(ctx->swrContext, totals);
+   return totals[type - PIPE_QUERY_DRIVER_SPECIFIC];
+}
+
+/* SwrSync callback, runs once every draw queued before the sync retired. */
+static void
+swr_ar_metric_cb(uint64_t userData, uint64_t userData2, uint64_t userData3)
+{
+   struct swr_context *ctx = (struct swr_context *)userData;
+   struct swr_query *pq = (struct swr_query *)userData2;
+   uint64_t value = swr_read_ar_metric(ctx, pq->type);
+
+   if (userData3)
+      pq->result.ar_metric_end = value;
+   else
+      pq->result.ar_metric_start = value;
+}
+
+/* Snapshot the running total of an ArchRast metric once the draws queued
+ * so far have completed, and fence the snapshot so that get_query_result
+ * waits for it. */
+static void
+swr_ar_metric_sync(struct swr_context *ctx, struct swr_query *pq, bool end)
+{
+   struct pipe_screen *screen = ctx->pipe.screen;
+
+   ctx->api.pfnSwrSync(ctx->swrContext, swr_ar_metric_cb,
+                       (uint64_t)ctx, (uint64_t)pq, end);
+
+   if (!pq->fence)
+      swr_fence_reference(screen, &pq->fence, swr_screen(screen)->flush_fence);
+   swr_fence_submit(ctx, pq->fence);
+}
+
+int
+swr_get_driver_query_info(struct pipe_screen *screen,
+                          unsigned index,
+                          struct pipe_driver_query_info *info)
+{
+   SWR_INTERFACE api;
+
+   swr_screen(screen)->pfnSwrGetInterface(api);
+   if (!api.pfnSwrGetArchRastMetrics(NULL, NULL))
+      return 0;
+
+   if (!info)
+      return SWR_AR_METRIC_COUNT;
+
+   if (index >= SWR_AR_METRIC_COUNT)
+      return 0;
+
+   info->name = swr_ar_metric_names[index];
+   info->query_type = PIPE_QUERY_DRIVER_SPECIFIC + index;
+   info->max_value.u64 = 0;
+   info->type = PIPE_DRIVER_QUERY_TYPE_UINT64;
+   info->result_type = PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE;
+   info->group_id = ~(unsigned)0;
+   info->flags = 0;
+   return 1;
+}
+
 static struct pipe_query *
 swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
 {
    struct swr_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES || swr_is_ar_metric_query(type));
    assert(index < MAX_SO_STREAMS);
 
    pq = (struct swr_query *) AlignedMalloc(sizeof(struct swr_query), 64);
@@ -89,6 +180,11 @@ swr_get_query_result(struct pipe_context *pipe,
       swr_fence_reference(pipe->screen, &pq->fence, NULL);
    }
 
+   if (swr_is_ar_metric_query(pq->type)) {
+      result->u64 = pq->result.ar_metric_end - pq->result.ar_metric_start;
+      return true;
+   }
+
    /* All values are reset to 0 at swr_begin_query, except starting timestamp.
     * Counters become simply end values.  */
    switch (pq->type) {
@@ -166,6 +262,15 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
 
    /* Initialize Results */
    memset(&pq->result, 0, sizeof(pq->result));
+
+   /* ArchRast metrics are published by the workers as draws complete; the
+    * query reports how much the running total moved between the
+    * completion of the draws queued before begin and before end. */
+   if (swr_is_ar_metric_query(pq->type)) {
+      swr_ar_metric_sync(ctx, pq, false);
+      return true;
+   }
+
    switch (pq->type) {
    case PIPE_QUERY_GPU_FINISHED:
    case PIPE_QUERY_TIMESTAMP:
@@ -198,6 +303,11 @@ swr_end_query(struct pipe_context *pipe, struct pipe_query *q)
    struct swr_context *ctx = swr_context(pipe);
    struct swr_query *pq = swr_query(q);
 
+   if (swr_is_ar_metric_query(pq->type)) {
+      swr_ar_metric_sync(ctx, pq, true);
+      return true;
+   }
+
    switch (pq->type) {
    case PIPE_QUERY_GPU_FINISHED:
       /* nothing to do, but don't want the default */
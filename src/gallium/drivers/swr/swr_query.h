@@ -32,6 +32,8 @@ struct swr_query_result {
    SWR_STATS_FE coreFE;
    uint64_t timestamp_start;
    uint64_t timestamp_end;
+   uint64_t ar_metric_start;
+   uint64_t ar_metric_end;
 };
 
 OSALIGNLINE(struct) swr_query {
@@ -44,5 +46,9 @@ OSALIGNLINE(struct) swr_query {
 
 extern void swr_query_init(struct pipe_context *pipe);
 
+extern int swr_get_driver_query_info(struct pipe_screen *screen,
+                                     unsigned index,
+                                     struct pipe_driver_query_info *info);
+
 extern bool swr_check_render_cond(struct pipe_context *pipe);
 #endif
@@ -26,6 +26,7 @@
 #include "swr_screen.h"
 #include "swr_resource.h"
 #include "swr_fence.h"
+#include "swr_query.h"
 #include "gen_knobs.h"
 
 #include "pipe/p_screen.h"
@@ -37,11 +38,16 @@
 #include "util/format/u_format_s3tc.h"
 #include "util/u_string.h"
 #include "util/u_screen.h"
+#include "util/disk_cache.h"
+#include "gallivm/lp_bld_misc.h"
 
 #include "frontend/sw_winsys.h"
 
 #include "jit_api.h"
 
+#include "llvm-c/ExecutionEngine.h"
+#include "llvm/Support/Host.h"
+
 #include "memory/TilingFunctions.h"
 
 #include <stdio.h>
@@ -1035,6 +1041,8 @@ swr_destroy_screen_internal(struct swr_screen **screen)
 
    JitDestroyContext((*screen)->hJitMgr);
 
+   disk_cache_destroy((*screen)->disk_shader_cache);
+
    if ((*screen)->pLibrary)
       util_dl_close((*screen)->pLibrary);
 
@@ -1043,6 +1051,91 @@ swr_destroy_screen_internal(struct swr_screen **screen)
 }
 
 
+static void
+swr_disk_cache_create(struct swr_screen *screen)
+{
+   struct mesa_sha1 ctx;
+   unsigned char sha1[20];
+   char cache_id[20 * 2 + 1];
+   _mesa_sha1_init(&ctx);
+
+   if (!disk_cache_get_function_identifier((void *)swr_disk_cache_create, &ctx) ||
+       !disk_cache_get_function_identifier((void *)LLVMLinkInMCJIT, &ctx))
+      return;
+
+   /* Everything is compiled for the host CPU */
+   std::string cpu = llvm::sys::getHostCPUName().str();
+   _mesa_sha1_update(&ctx, cpu.c_str(), cpu.size());
+
+   _mesa_sha1_final(&ctx, sha1);
+   disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
+
+   screen->disk_shader_cache = disk_cache_create("swr", cache_id, 0);
+}
+
+static struct disk_cache *
+swr_get_disk_shader_cache(struct pipe_screen *p_screen)
+{
+   return swr_screen(p_screen)->disk_shader_cache;
+}
+
+void
+swr_disk_cache_find_shader(struct swr_screen *screen,
+                           struct lp_cached_code *cache,
+                           unsigned char ir_sha1_cache_key[20])
+{
+   unsigned char sha1[CACHE_KEY_SIZE];
+
+   if (!screen->disk_shader_cache)
+      return;
+   disk_cache_compute_key(screen->disk_shader_cache, ir_sha1_cache_key, 20, sha1);
+
+   size_t binary_size;
+   uint8_t *buffer = disk_cache_get(screen->disk_shader_cache, sha1, &binary_size);
+   if (!buffer) {
+      cache->data_size = 0;
+      return;
+   }
+   cache->data_size = binary_size;
+   cache->data = buffer;
+}
+
+void
+swr_disk_cache_insert_shader(struct swr_screen *screen,
+                             struct lp_cached_code *cache,
+                             unsigned char ir_sha1_cache_key[20])
+{
+   unsigned char sha1[CACHE_KEY_SIZE];
+
+   if (!screen->disk_shader_cache || !cache->data_size || cache->dont_cache)
+      return;
+   disk_cache_compute_key(screen->disk_shader_cache, ir_sha1_cache_key, 20, sha1);
+   disk_cache_put(screen->disk_shader_cache, sha1, cache->data, cache->data_size, NULL);
+}
+
+/* Object cache callbacks for the fetch, blend and streamout jitter */
+static void * JITCALL
+swr_jit_cache_get(void *pPrivate, const void *pKey, size_t keySize,
+                  size_t *pObjSize)
+{
+   struct swr_screen *screen = (struct swr_screen *)pPrivate;
+   unsigned char sha1[CACHE_KEY_SIZE];
+
+   disk_cache_compute_key(screen->disk_shader_cache, pKey, keySize, sha1);
+   return disk_cache_get(screen->disk_shader_cache, sha1, pObjSize);
+}
+
+static void JITCALL
+swr_jit_cache_put(void *pPrivate, const void *pKey, size_t keySize,
+                  const void *pObj, size_t objSize)
+{
+   struct swr_screen *screen = (struct swr_screen *)pPrivate;
+   unsigned char sha1[CACHE_KEY_SIZE];
+
+   disk_cache_compute_key(screen->disk_shader_cache, pKey, keySize, sha1);
+   disk_cache_put(screen->disk_shader_cache, sha1, pObj, objSize, NULL);
+}
+
 static void
 swr_destroy_screen(struct pipe_screen *p_screen)
 {
@@ -1123,15 +1216,22 @@ swr_create_screen_internal(struct sw_winsys *winsys)
    screen->base.get_param = swr_get_param;
    screen->base.get_shader_param = swr_get_shader_param;
    screen->base.get_paramf = swr_get_paramf;
+   screen->base.get_driver_query_info = swr_get_driver_query_info;
 
    screen->base.resource_create = swr_resource_create;
    screen->base.resource_destroy = swr_resource_destroy;
 
    screen->base.flush_frontbuffer = swr_flush_frontbuffer;
+   screen->base.get_disk_shader_cache = swr_get_disk_shader_cache;
 
    // Pass in "" for architecture for run-time determination
    screen->hJitMgr = JitCreateContext(KNOB_SIMD_WIDTH, "", "swr");
 
+   swr_disk_cache_create(screen);
+   if (screen->disk_shader_cache)
+      JitSetObjectCache(screen->hJitMgr, screen,
+                        swr_jit_cache_get, swr_jit_cache_put);
+
    swr_fence_init(&screen->base);
 
    swr_validate_env_options(screen);
@@ -38,6 +38,8 @@
 #include <stdarg.h>
 
 struct sw_winsys;
+struct disk_cache;
+struct lp_cached_code;
 
 struct swr_screen {
    struct pipe_screen base;
@@ -54,6 +56,9 @@ struct swr_screen {
 
    HANDLE hJitMgr;
 
+   /* Compiled shaders and fetch/blend/streamout functions */
+   struct disk_cache *disk_shader_cache;
+
    /* Dynamic backend implementations */
    util_dl_library *pLibrary;
    PFNSwrGetInterface pfnSwrGetInterface;
@@ -72,6 +77,14 @@ swr_screen(struct pipe_screen *pipe)
 SWR_FORMAT
 mesa_to_swr_format(enum pipe_format format);
 
+void swr_disk_cache_find_shader(struct swr_screen *screen,
+                                struct lp_cached_code *cache,
+                                unsigned char ir_sha1_cache_key[20]);
+
+void swr_disk_cache_insert_shader(struct swr_screen *screen,
+                                  struct lp_cached_code *cache,
+                                  unsigned char ir_sha1_cache_key[20]);
+
 INLINE void swr_print_info(const char *format, ...)
 {
    static bool print_info = debug_get_bool_option("SWR_PRINT_INFO", false);
@@ -44,8 +44,10 @@
 #include "functionpasses/passes.h"
 
 #include "tgsi/tgsi_strings.h"
+#include "tgsi/tgsi_parse.h"
 #include "util/format/u_format.h"
 #include "util/u_prim.h"
+#include "util/mesa-sha1.h"
 #include "gallivm/lp_bld_init.h"
 #include "gallivm/lp_bld_flow.h"
 #include "gallivm/lp_bld_struct.h"
@@ -53,6 +55,7 @@
 #include "gallivm/lp_bld_const.h"
 #include "gallivm/lp_bld_printf.h"
 #include "gallivm/lp_bld_logic.h"
+#include "gallivm/lp_bld_misc.h"
 
 #include "swr_context.h"
 #include "gen_surf_state_llvm.h"
@@ -323,22 +326,52 @@ swr_generate_tes_key(struct swr_jit_tes_key &key,
 }
 
 struct BuilderSWR : public Builder {
-   BuilderSWR(JitManager *pJitMgr, const char *pName)
-      : Builder(pJitMgr)
+   /* The variant is looked up in the screen's disk cache by stage, key
+    * and tokens; on a hit gallivm skips optimization and codegen. */
+   BuilderSWR(struct swr_context *ctx, const char *pName,
+              const struct tgsi_token *tokens,
+              const void *key, size_t key_size)
+      : Builder(reinterpret_cast<JitManager *>(
+                   swr_screen(ctx->pipe.screen)->hJitMgr)),
+        screen(swr_screen(ctx->pipe.screen)), needs_caching(false)
    {
-      pJitMgr->SetupNewModule();
-      gallivm = gallivm_create(pName, wrap(&JM()->mContext), NULL);
-      pJitMgr->mpCurrentModule = unwrap(gallivm->module);
+      struct mesa_sha1 sha1_ctx;
+
+      memset(&cached, 0, sizeof(cached));
+      _mesa_sha1_init(&sha1_ctx);
+      _mesa_sha1_update(&sha1_ctx, pName, strlen(pName));
+      _mesa_sha1_update(&sha1_ctx, key, key_size);
+      _mesa_sha1_update(&sha1_ctx, tokens,
+                        tgsi_num_tokens(tokens) * sizeof(struct tgsi_token));
+      _mesa_sha1_final(&sha1_ctx, ir_sha1_cache_key);
+
+      swr_disk_cache_find_shader(screen, &cached, ir_sha1_cache_key);
+      needs_caching = !cached.data_size;
+
+      JM()->SetupNewModule();
+      gallivm = gallivm_create(pName, wrap(&JM()->mContext), &cached);
+      JM()->mpCurrentModule = unwrap(gallivm->module);
    }
 
    ~BuilderSWR() {
       gallivm_free_ir(gallivm);
    }
 
+   /* Call once the function is jitted, while the object is still around */
+   void StoreInDiskCache() {
+      if (needs_caching)
+         swr_disk_cache_insert_shader(screen, &cached, ir_sha1_cache_key);
+   }
+
    void WriteVS(Value *pVal, Value *pVsContext, Value *pVtxOutput,
                 unsigned slot, unsigned channel);
 
    struct gallivm_state *gallivm;
+   struct swr_screen *screen;
+   struct lp_cached_code cached;
+   unsigned char ir_sha1_cache_key[20];
+   bool needs_caching;
+
    PFN_VERTEX_FUNC CompileVS(struct swr_context *ctx, swr_jit_vs_key &key);
    PFN_PIXEL_KERNEL CompileFS(struct swr_context *ctx, swr_jit_fs_key &key);
    PFN_GS_FUNC CompileGS(struct swr_context *ctx, swr_jit_gs_key &key);
@@ -2251,10 +2284,9 @@ BuilderSWR::CompileTCS(struct swr_context *ctx, swr_jit_tcs_key &key)
 PFN_GS_FUNC
 swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key)
 {
-   BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "GS");
+   BuilderSWR builder(ctx, "GS", ctx->gs->pipe.tokens, &key, sizeof(key));
    PFN_GS_FUNC func = builder.CompileGS(ctx, key);
+   builder.StoreInDiskCache();
 
    ctx->gs->map.insert(std::make_pair(key, std::unique_ptr<VariantGS>(new VariantGS(builder.gallivm, func))));
    return func;
@@ -2263,10 +2295,9 @@ swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key)
 PFN_TCS_FUNC
 swr_compile_tcs(struct swr_context *ctx, swr_jit_tcs_key &key)
 {
-   BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "TCS");
+   BuilderSWR builder(ctx, "TCS", ctx->tcs->pipe.tokens, &key, sizeof(key));
    PFN_TCS_FUNC func = builder.CompileTCS(ctx, key);
+   builder.StoreInDiskCache();
 
    ctx->tcs->map.insert(
       std::make_pair(key, std::unique_ptr<VariantTCS>(new VariantTCS(builder.gallivm, func))));
@@ -2277,10 +2308,9 @@ swr_compile_tcs(struct swr_context *ctx, swr_jit_tcs_key &key)
 PFN_TES_FUNC
 swr_compile_tes(struct swr_context *ctx, swr_jit_tes_key &key)
 {
-   BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "TES");
+   BuilderSWR builder(ctx, "TES", ctx->tes->pipe.tokens, &key, sizeof(key));
    PFN_TES_FUNC func = builder.CompileTES(ctx, key);
+   builder.StoreInDiskCache();
 
    ctx->tes->map.insert(
       std::make_pair(key, std::unique_ptr<VariantTES>(new VariantTES(builder.gallivm, func))));
@@ -2555,10 +2585,9 @@ swr_compile_vs(struct swr_context *ctx, swr_jit_vs_key &key)
    if (!ctx->vs->pipe.tokens)
       return NULL;
 
-   BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "VS");
+   BuilderSWR builder(ctx, "VS", ctx->vs->pipe.tokens, &key, sizeof(key));
    PFN_VERTEX_FUNC func = builder.CompileVS(ctx, key);
+   builder.StoreInDiskCache();
 
    ctx->vs->map.insert(std::make_pair(key, std::unique_ptr<VariantVS>(new VariantVS(builder.gallivm, func))));
    return func;
@@ -3026,10 +3055,9 @@ swr_compile_fs(struct swr_context *ctx, swr_jit_fs_key &key)
    if (!ctx->fs->pipe.tokens)
       return NULL;
 
-   BuilderSWR builder(
-      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "FS");
+   BuilderSWR builder(ctx, "FS", ctx->fs->pipe.tokens, &key, sizeof(key));
    PFN_PIXEL_KERNEL func = builder.CompileFS(ctx, key);
+   builder.StoreInDiskCache();
 
    ctx->fs->map.insert(std::make_pair(key, std::unique_ptr<VariantFS>(new VariantFS(builder.gallivm, func))));
    return func;
@@ -21,12 +21,15 @@
 //
 
 #include <algorithm>
+#include <iostream>
 #include <unistd.h>
 #include "core/device.hpp"
 #include "core/platform.hpp"
+#include "llvm/invocation.hpp"
 #include "pipe/p_screen.h"
 #include "pipe/p_state.h"
 #include "util/bitscan.h"
+#include "util/disk_cache.h"
 #include "util/u_debug.h"
 
 using namespace clover;
@@ -45,14 +48,19 @@ namespace {
 }
 
 device::device(clover::platform &platform, pipe_loader_device *ldev) :
-   platform(platform), ldev(ldev) {
+   platform(platform), program_cache_hits(0), program_cache_misses(0),
+   ldev(ldev), _program_cache(NULL) {
    pipe = pipe_loader_create_screen(ldev);
    if (pipe && pipe->get_param(pipe, PIPE_CAP_COMPUTE)) {
-      if (supports_ir(PIPE_SHADER_IR_NATIVE))
+      if (supports_ir(PIPE_SHADER_IR_NATIVE)) {
+         create_program_cache();
          return;
+      }
 #ifdef HAVE_CLOVER_SPIRV
-      if (supports_ir(PIPE_SHADER_IR_NIR_SERIALIZED))
+      if (supports_ir(PIPE_SHADER_IR_NIR_SERIALIZED)) {
+         create_program_cache();
          return;
+      }
 #endif
    }
    if (pipe)
@@ -61,12 +69,55 @@ device::device(clover::platform &platform, pipe_loader_device *ldev) :
 }
 
 device::~device() {
+   if (_program_cache) {
+      if (debug_get_bool_option("CLOVER_CACHE_STATS", false))
+         std::cerr << "clover: " << device_name() << ": program cache hits = "
+                   << program_cache_hits << ", misses = "
+                   << program_cache_misses << std::endl;
+
+      disk_cache_destroy(_program_cache);
+   }
    if (pipe)
       pipe->destroy(pipe);
    if (ldev)
       pipe_loader_release(&ldev, 1);
 }
 
+void
+device::create_program_cache() {
+   struct mesa_sha1 ctx;
+   unsigned char sha1[20];
+   char cache_id[20 * 2 + 1];
+
+   _mesa_sha1_init(&ctx);
+
+   // Builds depend on the OpenCL library itself, on the compiler
+   // toolchain it uses and on the driver.
+   if (!disk_cache_get_function_identifier(
+          reinterpret_cast<void *>(&disk_cache_create), &ctx) ||
+       !llvm::hash_toolchain(*this, ctx) ||
+       !disk_cache_get_function_identifier(
+          reinterpret_cast<void *>(pipe->destroy), &ctx))
+      return;
+
+   const std::string id = device_name() + '\n' + vendor_name() + '\n' +
+      device_version() + '\n' + device_clc_version() + '\n' +
+      std::to_string(ir_format()) + '\n' + ir_target() + '\n' +
+      std::to_string(address_bits()) + '\n' +
+      std::to_string(endianness()) + '\n' + supported_extensions();
+   _mesa_sha1_update(&ctx, id.data(), id.size());
+
+   _mesa_sha1_final(&ctx, sha1);
+   disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
+
+   _program_cache = disk_cache_create("clover", cache_id, 0);
+}
+
+disk_cache *
+device::program_cache() const {
+   return _program_cache;
+}
+
 bool
 device::operator==(const device &dev) const {
    return this == &dev;
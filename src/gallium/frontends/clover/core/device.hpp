@@ -23,6 +23,7 @@
 #ifndef CLOVER_CORE_DEVICE_HPP
 #define CLOVER_CORE_DEVICE_HPP
 
+#include <atomic>
 #include <set>
 #include <vector>
 
@@ -30,6 +31,8 @@
 #include "core/format.hpp"
 #include "pipe-loader/pipe_loader.h"
 
+struct disk_cache;
+
 namespace clover {
    class platform;
    class root_resource;
@@ -94,16 +97,29 @@ namespace clover {
       supported_formats(const context &, cl_mem_object_type);
       const void *get_compiler_options(enum pipe_shader_ir ir) const;
 
+      ///
+      /// On-disk cache of program builds for this device, or NULL if
+      /// caching is disabled.  Keys computed with disk_cache_compute_key()
+      /// already account for the device, driver and compiler build.
+      ///
+      disk_cache *program_cache() const;
+
       clover::platform &platform;
 
+      mutable std::atomic<unsigned> program_cache_hits;
+      mutable std::atomic<unsigned> program_cache_misses;
+
       inline bool
       has_system_svm() const {
          return svm_support() & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM;
       }
 
    private:
+      void create_program_cache();
+
       pipe_screen *pipe;
       pipe_loader_device *ldev;
+      disk_cache *_program_cache;
    };
 }
 
@@ -135,6 +135,7 @@ namespace clover {
    private:
       virtual void fence(pipe_fence_handle *fence);
       action profile(command_queue &q, const action &action) const;
+      static action serialize(command_queue &q, const action &action);
 
       const intrusive_ref<command_queue> _queue;
       cl_command_type _command;
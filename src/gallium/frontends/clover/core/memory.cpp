@@ -83,6 +83,9 @@ root_buffer::root_buffer(clover::context &ctx, cl_mem_flags flags,
 
 resource &
 root_buffer::resource(command_queue &q) {
+   std::lock_guard<std::recursive_mutex> pipe_lock(q.pipe_mutex);
+   std::lock_guard<std::mutex> lock(resources_mutex);
+
    // Create a new resource if there's none for this device yet.
    if (!resources.count(&q.device())) {
       auto r = (!resources.empty() ?
@@ -107,6 +110,9 @@ sub_buffer::sub_buffer(root_buffer &parent, cl_mem_flags flags,
 
 resource &
 sub_buffer::resource(command_queue &q) {
+   std::lock_guard<std::recursive_mutex> pipe_lock(q.pipe_mutex);
+   std::lock_guard<std::mutex> lock(resources_mutex);
+
    // Create a new resource if there's none for this device yet.
    if (!resources.count(&q.device())) {
       auto r = new sub_resource(parent().resource(q), {{ offset() }});
@@ -135,6 +141,9 @@ image::image(clover::context &ctx, cl_mem_flags flags,
 
 resource &
 image::resource(command_queue &q) {
+   std::lock_guard<std::recursive_mutex> pipe_lock(q.pipe_mutex);
+   std::lock_guard<std::mutex> lock(resources_mutex);
+
    // Create a new resource if there's none for this device yet.
    if (!resources.count(&q.device())) {
       auto r = (!resources.empty() ?
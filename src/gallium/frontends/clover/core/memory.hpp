@@ -26,6 +26,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <stack>
 
 #include "core/object.hpp"
@@ -66,6 +67,13 @@ namespace clover {
 
    protected:
       std::string data;
+
+      /// Protects the per-device resources of the object and \a data.
+      /// Lock order: the command_queue::pipe_mutex of the queue the
+      /// resource is created for, then this mutex, then the
+      /// resources_mutex of the parent buffer for sub-buffers.  Never
+      /// take pipe_mutex while holding this mutex.
+      std::mutex resources_mutex;
    };
 
    class buffer : public memory_obj {
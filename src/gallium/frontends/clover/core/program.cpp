@@ -20,11 +20,118 @@
 // OTHER DEALINGS IN THE SOFTWARE.
 //
 
+#include <sstream>
+
 #include "core/compiler.hpp"
 #include "core/program.hpp"
+#include "util/disk_cache.h"
 
 using namespace clover;
 
+namespace {
+   void
+   write_string(std::ostream &os, const std::string &s) {
+      const uint32_t size = s.size();
+      os.write(reinterpret_cast<const char *>(&size), sizeof(size));
+      os.write(s.data(), size);
+   }
+
+   std::string
+   read_string(std::istream &is) {
+      uint32_t size;
+      is.read(reinterpret_cast<char *>(&size), sizeof(size));
+      std::string s(size, '\0');
+      is.read(&s[0], size);
+      return s;
+   }
+
+   bool
+   includes_files(const std::string &source, const header_map &headers) {
+      std::istringstream is(source);
+      std::string line;
+
+      while (std::getline(is, line)) {
+         auto i = line.find_first_not_of(" \t");
+         if (i == std::string::npos || line[i] != '#')
+            continue;
+
+         i = line.find_first_not_of(" \t", i + 1);
+         if (i == std::string::npos || line.compare(i, 7, "include"))
+            continue;
+
+         i = line.find_first_of("<\"", i + 7);
+         const auto j = line.find_first_of(">\"", i + 1);
+         if (i == std::string::npos || j == std::string::npos ||
+             !any_of(key_equals(line.substr(i + 1, j - i - 1)), headers))
+            return true;
+      }
+
+      return false;
+   }
+
+   ///
+   /// Whether compiling \a source may read files from the file system,
+   /// whose contents cannot be accounted for in a cache key.
+   ///
+   bool
+   reads_files(const std::string &source, const header_map &headers,
+               const std::string &opts) {
+      return opts.find("-include") != std::string::npos ||
+             opts.find("-imacros") != std::string::npos ||
+             includes_files(source, headers) ||
+             any_of([&](const std::pair<std::string, std::string> &header) {
+                  return includes_files(header.second, headers);
+               }, headers);
+   }
+
+   ///
+   /// Return the module built from \a inputs from the program cache of
+   /// \a dev if there is one, otherwise call \a build and store its
+   /// result together with the build log it produced.
+   ///
+   template<typename F>
+   module
+   cached_build(const device &dev, const std::string &inputs,
+                std::string &log, F build) {
+      disk_cache *cache = dev.program_cache();
+      if (!cache)
+         return build();
+
+      cache_key key;
+      disk_cache_compute_key(cache, inputs.data(), inputs.size(), key);
+
+      size_t size;
+      if (void *data = disk_cache_get(cache, key, &size)) {
+         std::istringstream is(std::string(static_cast<char *>(data), size));
+         free(data);
+
+         try {
+            is.exceptions(std::ios::failbit | std::ios::badbit);
+            const std::string cached_log = read_string(is);
+            const module m = module::deserialize(is);
+            log += cached_log;
+            dev.program_cache_hits++;
+            return m;
+         } catch (std::ios::failure &) {
+            // Fall back to a real build if the entry is unreadable.
+         }
+      }
+
+      dev.program_cache_misses++;
+
+      const auto log_start = log.size();
+      const module m = build();
+
+      std::ostringstream os;
+      write_string(os, log.substr(log_start));
+      m.serialize(os);
+      const std::string blob = os.str();
+      disk_cache_put(cache, key, blob.data(), blob.size(), NULL);
+
+      return m;
+   }
+}
+
 program::program(clover::context &ctx, const std::string &source) :
    has_source(true), context(ctx), _devices(ctx.devices()), _source(source),
    _kernel_ref_counter(0) {
@@ -50,9 +157,22 @@ program::compile(const ref_vector<device> &devs, const std::string &opts,
       for (auto &dev : devs) {
          std::string log;
 
+         std::ostringstream inputs;
+         write_string(inputs, "compile");
+         write_string(inputs, opts);
+         write_string(inputs, _source);
+         for (auto &header : headers) {
+            write_string(inputs, header.first);
+            write_string(inputs, header.second);
+         }
+
          try {
-            const module m =
-               compiler::compile_program(_source, headers, dev, opts, log);
+            const auto build = [&]() {
+               return compiler::compile_program(_source, headers, dev,
+                                                opts, log);
+            };
+            const module m = reads_files(_source, headers, opts) ? build() :
+               cached_build(dev, inputs.str(), log, build);
             _builds[&dev] = { m, opts, log };
          } catch (...) {
             _builds[&dev] = { module(), opts, log };
@@ -73,8 +193,16 @@ program::link(const ref_vector<device> &devs, const std::string &opts,
          }, progs);
       std::string log = _builds[&dev].log;
 
+      std::ostringstream inputs;
+      write_string(inputs, "link");
+      write_string(inputs, opts);
+      for (auto &m : ms)
+         m.serialize(inputs);
+
       try {
-         const module m = compiler::link_program(ms, dev, opts, log);
+         const module m = cached_build(dev, inputs.str(), log, [&]() {
+               return compiler::link_program(ms, dev, opts, log);
+            });
          _builds[&dev] = { m, opts, log };
       } catch (...) {
          _builds[&dev] = { module(), opts, log };
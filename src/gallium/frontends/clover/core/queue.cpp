@@ -70,14 +70,25 @@ command_queue::flush() {
 
    std::lock_guard<std::mutex> lock(queued_events_mutex);
    if (!queued_events.empty()) {
-      pipe->flush(pipe, &fence, 0);
+      {
+         std::lock_guard<std::recursive_mutex> pipe_lock(pipe_mutex);
+         pipe->flush(pipe, &fence, 0);
+      }
 
-      while (!queued_events.empty() &&
-             queued_events.front()().signalled()) {
-         queued_events.front()().fence(fence);
-         queued_events.pop_front();
+      // Events of an out-of-order queue may be signalled in any order, the
+      // ones still waiting for something stay on the list.
+      for (auto it = queued_events.begin(); it != queued_events.end();) {
+         if ((*it)().signalled()) {
+            (*it)().fence(fence);
+            it = queued_events.erase(it);
+         } else {
+            ++it;
+         }
       }
 
+      if (last_barrier && last_barrier->signalled())
+         last_barrier = NULL;
+
       screen->fence_reference(screen, &fence, NULL);
    }
 }
@@ -92,11 +103,39 @@ command_queue::profiling_enabled() const {
    return props & CL_QUEUE_PROFILING_ENABLE;
 }
 
+bool
+command_queue::out_of_order() const {
+   return props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+}
+
 void
 command_queue::sequence(hard_event &ev) {
    std::lock_guard<std::mutex> lock(queued_events_mutex);
-   if (!queued_events.empty())
-      queued_events.back()().chain(ev);
+
+   if (!out_of_order()) {
+      if (!queued_events.empty())
+         queued_events.back()().chain(ev);
+
+   } else {
+      // Markers and barriers with an empty wait list (and the events
+      // clFinish() creates) complete after every previous command, and
+      // barriers hold back every later command.  Events that were
+      // flushed already have been executed.
+      const bool barrier = (ev.command() == CL_COMMAND_BARRIER ||
+                            ev.command() == 0);
+      const bool wait_all = (ev.deps.empty() &&
+                             (barrier || ev.command() == CL_COMMAND_MARKER));
+
+      if (wait_all) {
+         for (auto &qev : queued_events)
+            qev().chain(ev);
+      } else if (last_barrier) {
+         last_barrier->chain(ev);
+      }
+
+      if (barrier)
+         last_barrier = &ev;
+   }
 
    queued_events.push_back(ev);
 }
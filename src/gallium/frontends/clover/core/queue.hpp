@@ -56,6 +56,9 @@ namespace clover {
 
       friend class resource;
       friend class root_resource;
+      friend class root_buffer;
+      friend class sub_buffer;
+      friend class image;
       friend class mapping;
       friend class hard_event;
       friend class sampler;
@@ -65,13 +68,24 @@ namespace clover {
 
    private:
       /// Serialize a hardware event with respect to the previous ones,
-      /// and push it to the pending list.
+      /// and push it to the pending list.  In out-of-order mode only
+      /// barriers (and markers waiting for every previous command) are
+      /// serialized, other events just depend on their wait list.
       void sequence(hard_event &ev);
 
+      bool out_of_order() const;
+
       cl_command_queue_properties props;
       pipe_context *pipe;
       std::mutex queued_events_mutex;
       std::deque<intrusive_ref<hard_event>> queued_events;
+      intrusive_ptr<hard_event> last_barrier;
+
+      /// Commands of an out-of-order queue may be triggered concurrently
+      /// from different threads, all of them use \a pipe under this lock.
+      /// It must be taken before the memory_obj::resources_mutex of any
+      /// memory object.
+      std::recursive_mutex pipe_mutex;
    };
 }
 
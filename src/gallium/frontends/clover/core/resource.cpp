@@ -145,7 +145,10 @@ root_resource::root_resource(clover::device &dev, memory_obj &obj,
                 PIPE_BIND_COMPUTE_RESOURCE |
                 PIPE_BIND_GLOBAL);
 
-   if (obj.flags() & CL_MEM_USE_HOST_PTR && dev.allows_user_pointers()) {
+   // Images are left out since the driver would impose its own row and
+   // slice pitch on the memory rather than the application's.
+   if (obj.flags() & CL_MEM_USE_HOST_PTR && dev.allows_user_pointers() &&
+       info.target == PIPE_BUFFER) {
       // Page alignment is normally required for this, just try, hope for the
       // best and fall back if it fails.
       pipe = dev.pipe->resource_from_user_memory(dev.pipe, &info, obj.host_ptr());
@@ -202,6 +205,7 @@ mapping::mapping(command_queue &q, resource &r,
                      (flags & CL_MAP_WRITE_INVALIDATE_REGION ?
                       PIPE_TRANSFER_DISCARD_RANGE : 0) |
                      (!blocking ? PIPE_TRANSFER_UNSYNCHRONIZED : 0));
+   std::lock_guard<std::recursive_mutex> lock(q.pipe_mutex);
 
    p = pctx->transfer_map(pctx, r.pipe, 0, usage,
                           box(origin + r.offset, region), &pxfer);
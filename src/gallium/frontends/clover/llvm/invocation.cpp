@@ -29,6 +29,7 @@
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm-c/Core.h>
 #include <llvm-c/Target.h>
 #ifdef HAVE_CLOVER_SPIRV
 #include <LLVMSPIRVLib/LLVMSPIRVLib.h>
@@ -39,6 +40,9 @@
 #include <clang/Frontend/TextDiagnosticBuffer.h>
 #include <clang/Frontend/TextDiagnosticPrinter.h>
 #include <clang/Basic/TargetInfo.h>
+#include <clang/Basic/Version.h>
+
+#include <sys/stat.h>
 
 // We need to include internal headers last, because the internal headers
 // include CL headers which have #define's like:
@@ -58,6 +62,7 @@
 #include "spirv/invocation.hpp"
 #endif
 #include "util/algorithm.hpp"
+#include "util/disk_cache.h"
 
 
 using namespace clover;
@@ -416,6 +421,26 @@ clover::llvm::link_program(const std::vector<module> &modules,
    }
 }
 
+bool
+clover::llvm::hash_toolchain(const device &dev, struct mesa_sha1 &ctx) {
+   if (!disk_cache_get_function_identifier(
+          reinterpret_cast<void *>(&LLVMContextCreate), &ctx))
+      return false;
+
+   const std::string version = clang::getClangFullVersion();
+   _mesa_sha1_update(&ctx, version.data(), version.size());
+
+   // libclc is usually packaged separately, so also account for the
+   // library bitcode linked into every program.
+   struct stat st;
+   if (stat((LIBCLC_LIBEXECDIR + dev.ir_target() + ".bc").c_str(), &st) == 0) {
+      _mesa_sha1_update(&ctx, &st.st_mtime, sizeof(st.st_mtime));
+      _mesa_sha1_update(&ctx, &st.st_size, sizeof(st.st_size));
+   }
+
+   return true;
+}
+
 #ifdef HAVE_CLOVER_SPIRV
 module
 clover::llvm::compile_to_spirv(const std::string &source,
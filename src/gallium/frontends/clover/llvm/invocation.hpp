@@ -28,6 +28,8 @@
 #include "core/program.hpp"
 #include "pipe/p_defines.h"
 
+struct mesa_sha1;
+
 namespace clover {
    namespace llvm {
       module compile_program(const std::string &source,
@@ -41,6 +43,14 @@ namespace clover {
                           const std::string &opts,
                           std::string &r_log);
 
+      ///
+      /// Hash the identity of the clang/LLVM libraries and of the libclc
+      /// installation used to build programs for \a dev into \a ctx.
+      ///
+      /// Returns false if it cannot be determined.
+      ///
+      bool hash_toolchain(const device &dev, struct mesa_sha1 &ctx);
+
 #ifdef HAVE_CLOVER_SPIRV
       module compile_to_spirv(const std::string &source,
                               const header_map &headers,
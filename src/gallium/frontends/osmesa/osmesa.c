@@ -31,16 +31,15 @@
  * Otherwise we use softpipe.  The GALLIUM_DRIVER environment variable
  * may be set to "softpipe" or "llvmpipe" to override.
  *
- * With softpipe we could render directly into the user's buffer by using a
- * display target resource.  However, softpipe doesn't support "upside-down"
- * rendering which would be needed for the OSMESA_Y_UP=TRUE case.
+ * When the driver can wrap user memory in a resource (llvmpipe) and the
+ * user's buffer has the layout the driver would use for it, we render
+ * directly into the user's buffer.  For the OSMESA_Y_UP=TRUE case the
+ * framebuffer is then created with the first row at the bottom, so that
+ * the viewport transformation does the flip.
  *
- * With llvmpipe we could only render directly into the user's buffer when its
- * width and height is a multiple of the tile size (64 pixels).
- *
- * Because of these constraints we always render into ordinary resources then
- * copy the results to the user's buffer in the flush_front() function which
- * is called when the app calls glFlush/Finish.
+ * Otherwise we render into ordinary resources then copy the results to the
+ * user's buffer in the flush_front() function which is called when the app
+ * calls glFlush/Finish.
  *
  * In general, the OSMesa interface is pretty ugly and not a good match
  * for Gallium.  But we're interested in doing the best we can to preserve
@@ -89,6 +88,14 @@ struct osmesa_buffer
 
    void *map;
 
+   /**
+    * Color buffer wrapping the user's buffer, rendered to in place, or NULL.
+    * It was created for user_color_map and user_color_stride.
+    */
+   struct pipe_resource *user_color;
+   void *user_color_map;
+   int user_color_stride;
+
    struct osmesa_buffer *next;  /**< next in linked list */
 };
 
@@ -305,9 +312,106 @@ stfbi_to_osbuffer(struct st_framebuffer_iface *stfbi)
 }
 
 
+/**
+ * Distance in bytes between rows of the user's buffer.
+ */
+static int
+osmesa_user_stride(const struct osmesa_context *osmesa,
+                   const struct osmesa_buffer *osbuffer)
+{
+   unsigned bpp = util_format_get_blocksize(osbuffer->visual.color_format);
+
+   if (osmesa->user_row_length)
+      return bpp * osmesa->user_row_length;
+   else
+      return bpp * osbuffer->width;
+}
+
+
+/**
+ * Try to create a color buffer resource using the user's buffer as its
+ * storage.  This works when the driver supports it and lays the resource
+ * out with the user's row stride.
+ */
+static struct pipe_resource *
+osmesa_wrap_user_buffer(struct osmesa_context *osmesa,
+                        struct osmesa_buffer *osbuffer)
+{
+   struct pipe_screen *screen = get_st_manager()->screen;
+   struct pipe_context *pipe = osmesa->stctx->pipe;
+   struct pipe_resource templat, *res;
+   struct pipe_transfer *transfer = NULL;
+   struct pipe_box box;
+   void *map;
+
+   if (!screen->resource_from_user_memory ||
+       osmesa->y_up != osbuffer->stfb->y_0_bottom)
+      return NULL;
+
+   memset(&templat, 0, sizeof(templat));
+   templat.target = PIPE_TEXTURE_RECT;
+   templat.format = osbuffer->visual.color_format;
+   templat.width0 = osbuffer->width;
+   templat.height0 = osbuffer->height;
+   templat.depth0 = 1;
+   templat.array_size = 1;
+   templat.usage = PIPE_USAGE_DEFAULT;
+   templat.bind = PIPE_BIND_RENDER_TARGET;
+
+   res = screen->resource_from_user_memory(screen, &templat, osbuffer->map);
+   if (!res)
+      return NULL;
+
+   u_box_2d(0, 0, res->width0, res->height0, &box);
+   map = pipe->transfer_map(pipe, res, 0, PIPE_TRANSFER_READ, &box,
+                            &transfer);
+   if (!map || map != osbuffer->map ||
+       transfer->stride != osmesa_user_stride(osmesa, osbuffer)) {
+      if (map)
+         pipe->transfer_unmap(pipe, transfer);
+      pipe_resource_reference(&res, NULL);
+      return NULL;
+   }
+   pipe->transfer_unmap(pipe, transfer);
+
+   return res;
+}
+
+
+/**
+ * Render in place into the user's buffer if its current map, row length
+ * and Y direction allow, or stop doing so if they no longer do.
+ */
+static void
+osmesa_update_user_color(struct osmesa_context *osmesa,
+                         struct osmesa_buffer *osbuffer)
+{
+   struct pipe_resource *res;
+
+   if (osbuffer->user_color &&
+       osbuffer->user_color_map == osbuffer->map &&
+       osbuffer->user_color_stride == osmesa_user_stride(osmesa, osbuffer) &&
+       osmesa->y_up == osbuffer->stfb->y_0_bottom)
+      return;
+
+   res = osmesa_wrap_user_buffer(osmesa, osbuffer);
+   if (!res && !osbuffer->user_color)
+      return;
+
+   pipe_resource_reference(&osbuffer->user_color, NULL);
+   osbuffer->user_color = res;
+   osbuffer->user_color_map = osbuffer->map;
+   osbuffer->user_color_stride = osmesa_user_stride(osmesa, osbuffer);
+
+   /* Make the state tracker validate the new color buffer */
+   p_atomic_inc(&osbuffer->stfb->stamp);
+}
+
+
 /**
  * Called via glFlush/glFinish.  This is where we copy the contents
- * of the driver's color buffer into the user-specified buffer.
+ * of the driver's color buffer into the user-specified buffer, unless
+ * we rendered directly into it.
  */
 static bool
 osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
@@ -324,6 +428,7 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
    ubyte *src, *dst;
    unsigned y, bytes, bpp;
    int dst_stride;
+   boolean flip;
 
    if (osmesa->pp) {
       struct pipe_resource *zsbuf = NULL;
@@ -352,19 +457,28 @@ osmesa_st_framebuffer_flush_front(struct st_context_iface *stctx,
    map = pipe->transfer_map(pipe, res, 0, PIPE_TRANSFER_READ, &box,
                             &transfer);
 
+   if (res == osbuffer->user_color) {
+      /* Rendered in place, mapping only waited for rendering to finish */
+      if (map)
+         pipe->transfer_unmap(pipe, transfer);
+      return true;
+   }
+
    /*
     * Copy the color buffer from the resource to the user's buffer.
     */
    bpp = util_format_get_blocksize(osbuffer->visual.color_format);
    src = map;
    dst = osbuffer->map;
-   if (osmesa->user_row_length)
-      dst_stride = bpp * osmesa->user_row_length;
-   else
-      dst_stride = bpp * osbuffer->width;
+   dst_stride = osmesa_user_stride(osmesa, osbuffer);
    bytes = bpp * res->width0;
 
-   if (osmesa->y_up) {
+   /* The first row of the resource is the top one, unless the framebuffer
+    * was created for rendering in place with OSMESA_Y_UP.
+    */
+   flip = osmesa->y_up != osbuffer->stfb->y_0_bottom;
+
+   if (flip) {
       /* need to flip image upside down */
       dst = dst + (res->height0 - 1) * dst_stride;
       dst_stride = -dst_stride;
@@ -439,6 +553,11 @@ osmesa_st_framebuffer_validate(struct st_context_iface *stctx,
       templat.format = format;
       templat.bind = bind;
       pipe_resource_reference(&out[i], NULL);
+      if (statts[i] == ST_ATTACHMENT_FRONT_LEFT && osbuffer->user_color) {
+         pipe_resource_reference(&out[i], osbuffer->user_color);
+         osbuffer->textures[statts[i]] = out[i];
+         continue;
+      }
       out[i] = osbuffer->textures[statts[i]] =
          screen->resource_create(screen, &templat);
    }
@@ -526,6 +645,7 @@ osmesa_destroy_buffer(struct osmesa_buffer *osbuffer)
     */
    stapi->destroy_drawable(stapi, osbuffer->stfb);
 
+   pipe_resource_reference(&osbuffer->user_color, NULL);
    FREE(osbuffer->stfb);
    FREE(osbuffer);
 }
@@ -764,6 +884,7 @@ OSMesaMakeCurrent(OSMesaContext osmesa, void *buffer, GLenum type,
    struct st_api *stapi = get_st_api();
    struct osmesa_buffer *osbuffer;
    enum pipe_format color_format;
+   boolean new_buffer = FALSE;
 
    if (!osmesa && !buffer) {
       stapi->make_current(stapi, NULL, NULL, NULL);
@@ -789,12 +910,22 @@ OSMesaMakeCurrent(OSMesaContext osmesa, void *buffer, GLenum type,
       osbuffer = osmesa_create_buffer(color_format,
                                       osmesa->depth_stencil_format,
                                       osmesa->accum_format);
+      new_buffer = TRUE;
    }
 
    osbuffer->width = width;
    osbuffer->height = height;
    osbuffer->map = buffer;
 
+   /* The Y direction of a framebuffer is fixed once it has been made
+    * current, so only flip it for OSMESA_Y_UP if we can render in place.
+    */
+   if (new_buffer)
+      osbuffer->stfb->y_0_bottom = osmesa->y_up;
+   osmesa_update_user_color(osmesa, osbuffer);
+   if (new_buffer && !osbuffer->user_color)
+      osbuffer->stfb->y_0_bottom = FALSE;
+
    /* XXX unused for now */
    (void) osmesa_destroy_buffer;
 
@@ -857,6 +988,9 @@ OSMesaPixelStore(GLint pname, GLint value)
       fprintf(stderr, "Invalid pname in OSMesaPixelStore()\n");
       return;
    }
+
+   if (osmesa->current_buffer)
+      osmesa_update_user_color(osmesa, osmesa->current_buffer);
 }
 
 
@@ -314,6 +314,13 @@ struct st_framebuffer_iface
     */
    const struct st_visual *visual;
 
+   /**
+    * Whether the first row of the color buffers is the bottom row of the
+    * image, instead of the top row as usual for window system framebuffers.
+    * It is read when the framebuffer is first made current.
+    */
+   bool y_0_bottom;
+
    /**
     * Flush the front buffer.
     *
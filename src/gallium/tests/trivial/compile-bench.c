@@ -0,0 +1,609 @@
+/*
+ * Copyright © 2020 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Offline compile throughput benchmark.
+ *
+ * Compiles a corpus of TGSI text shaders through the create_*_state hooks
+ * of whatever device the pipe-loader finds, on several threads with one
+ * pipe_context each, and reports per stage compile times, throughput and
+ * peak memory.  Each compile is timed up to and including the matching
+ * delete_*_state, since drivers that compile asynchronously wait for the
+ * result there.
+ *
+ * The on-disk shader cache is disabled, and every iteration runs on a new
+ * screen and new contexts, so that repeated compiles of a shader are not
+ * served from a driver's disk or in-memory shader cache.
+ *
+ * To run it on the CPU only, preload one of the no-op drm-shim backends,
+ * for example:
+ *
+ *   LD_PRELOAD=libiris_noop_drm_shim.so compile-bench -j 8 shaders/
+ *
+ * Results of a run can be saved with -o and compared against with -c.
+ */
+
+#include <dirent.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "c11/threads.h"
+
+#include "pipe/p_context.h"
+#include "pipe/p_defines.h"
+#include "pipe/p_screen.h"
+#include "pipe/p_shader_tokens.h"
+#include "pipe/p_state.h"
+#include "util/hash_table.h"
+#include "util/os_time.h"
+#include "util/ralloc.h"
+#include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_memory.h"
+#include "tgsi/tgsi_parse.h"
+#include "tgsi/tgsi_strings.h"
+#include "tgsi/tgsi_text.h"
+#include "pipe-loader/pipe_loader.h"
+
+#define MAX_TOKENS 65536
+
+struct shader {
+	char *name;
+	enum pipe_shader_type stage;
+	struct tgsi_token *tokens;
+	bool skip;
+
+	/* Fastest of all iterations: */
+	uint64_t best_ns;
+};
+
+struct bench {
+	struct pipe_loader_device *dev;
+	struct pipe_screen *screen;
+
+	struct shader *shaders;
+	unsigned num_shaders;
+	unsigned iterations;
+
+	/* Next shader to compile in the current iteration: */
+	unsigned next;
+};
+
+static int
+compare_names(const void *a, const void *b)
+{
+	return strcmp(((const struct shader *)a)->name,
+		      ((const struct shader *)b)->name);
+}
+
+static char *
+read_file(const char *path)
+{
+	struct stat st;
+	char *buf;
+	FILE *f;
+
+	f = fopen(path, "rb");
+	if (!f)
+		return NULL;
+
+	if (fstat(fileno(f), &st) || !(buf = malloc(st.st_size + 1))) {
+		fclose(f);
+		return NULL;
+	}
+
+	if (fread(buf, 1, st.st_size, f) != (size_t)st.st_size) {
+		free(buf);
+		buf = NULL;
+	} else {
+		buf[st.st_size] = '\0';
+	}
+
+	fclose(f);
+	return buf;
+}
+
+static void
+add_shader(struct bench *b, const char *path)
+{
+	struct tgsi_token *tokens;
+	struct shader *s;
+	char *text;
+
+	text = read_file(path);
+	if (!text) {
+		fprintf(stderr, "could not read %s\n", path);
+		return;
+	}
+
+	tokens = MALLOC(MAX_TOKENS * sizeof(*tokens));
+	if (!tgsi_text_translate(text, tokens, MAX_TOKENS)) {
+		fprintf(stderr, "could not parse %s\n", path);
+		FREE(tokens);
+		free(text);
+		return;
+	}
+	free(text);
+
+	b->shaders = realloc(b->shaders, (b->num_shaders + 1) * sizeof(*s));
+	s = &b->shaders[b->num_shaders++];
+	memset(s, 0, sizeof(*s));
+	s->name = strdup(path);
+	s->stage = tgsi_get_processor_type(tokens);
+	s->tokens = REALLOC(tokens, MAX_TOKENS * sizeof(*tokens),
+			    tgsi_num_tokens(tokens) * sizeof(*tokens));
+}
+
+static void
+add_path(struct bench *b, const char *path)
+{
+	struct dirent *entry;
+	struct stat st;
+	DIR *dir;
+
+	if (stat(path, &st) || !S_ISDIR(st.st_mode)) {
+		add_shader(b, path);
+		return;
+	}
+
+	dir = opendir(path);
+	if (!dir)
+		return;
+
+	while ((entry = readdir(dir))) {
+		const char *ext = strrchr(entry->d_name, '.');
+		char *child;
+
+		if (entry->d_name[0] == '.')
+			continue;
+		if (asprintf(&child, "%s/%s", path, entry->d_name) < 0)
+			continue;
+
+		if (!stat(child, &st) && S_ISDIR(st.st_mode))
+			add_path(b, child);
+		else if (ext && !strcmp(ext, ".tgsi"))
+			add_shader(b, child);
+
+		free(child);
+	}
+
+	closedir(dir);
+}
+
+static bool
+stage_supported(struct pipe_screen *screen, enum pipe_shader_type stage)
+{
+	if (!screen->get_shader_param(screen, stage,
+				      PIPE_SHADER_CAP_MAX_INSTRUCTIONS))
+		return false;
+
+	if (stage == PIPE_SHADER_COMPUTE) {
+		int irs = screen->get_shader_param(screen, stage,
+						   PIPE_SHADER_CAP_SUPPORTED_IRS);
+		return irs & (1 << PIPE_SHADER_IR_TGSI);
+	}
+
+	return true;
+}
+
+static uint64_t
+compile_shader(struct pipe_context *pipe, const struct shader *s)
+{
+	struct pipe_shader_state state;
+	struct pipe_compute_state cs;
+	int64_t start = os_time_get_nano();
+	void *cso;
+
+	pipe_shader_state_from_tgsi(&state, s->tokens);
+
+	switch (s->stage) {
+	case PIPE_SHADER_VERTEX:
+		cso = pipe->create_vs_state(pipe, &state);
+		pipe->delete_vs_state(pipe, cso);
+		break;
+	case PIPE_SHADER_TESS_CTRL:
+		cso = pipe->create_tcs_state(pipe, &state);
+		pipe->delete_tcs_state(pipe, cso);
+		break;
+	case PIPE_SHADER_TESS_EVAL:
+		cso = pipe->create_tes_state(pipe, &state);
+		pipe->delete_tes_state(pipe, cso);
+		break;
+	case PIPE_SHADER_GEOMETRY:
+		cso = pipe->create_gs_state(pipe, &state);
+		pipe->delete_gs_state(pipe, cso);
+		break;
+	case PIPE_SHADER_FRAGMENT:
+		cso = pipe->create_fs_state(pipe, &state);
+		pipe->delete_fs_state(pipe, cso);
+		break;
+	case PIPE_SHADER_COMPUTE:
+		memset(&cs, 0, sizeof(cs));
+		cs.ir_type = PIPE_SHADER_IR_TGSI;
+		cs.prog = s->tokens;
+		cso = pipe->create_compute_state(pipe, &cs);
+		pipe->delete_compute_state(pipe, cso);
+		break;
+	default:
+		unreachable("bad shader stage");
+	}
+
+	return os_time_get_nano() - start;
+}
+
+static int
+bench_thread(void *data)
+{
+	struct bench *b = data;
+	struct pipe_context *pipe;
+
+	pipe = b->screen->context_create(b->screen, NULL, 0);
+	if (!pipe) {
+		fprintf(stderr, "could not create a context\n");
+		return 1;
+	}
+
+	for (unsigned i;
+	     (i = p_atomic_inc_return(&b->next) - 1) < b->num_shaders;) {
+		struct shader *s = &b->shaders[i];
+		uint64_t ns, best;
+
+		if (s->skip)
+			continue;
+
+		ns = compile_shader(pipe, s);
+
+		do {
+			best = p_atomic_read(&s->best_ns);
+		} while ((!best || ns < best) &&
+			 p_atomic_cmpxchg(&s->best_ns, best, ns) != best);
+	}
+
+	pipe->destroy(pipe);
+	return 0;
+}
+
+/*
+ * Compiles every shader once on num_threads threads, each with its own
+ * context on b->screen.  Returns the wall time, or 0 on failure.
+ */
+static uint64_t
+run_iteration(struct bench *b, thrd_t *threads, unsigned num_threads)
+{
+	unsigned started = 0;
+	bool failed = false;
+	int64_t start;
+
+	b->next = 0;
+
+	start = os_time_get_nano();
+	for (; started < num_threads; started++) {
+		if (thrd_create(&threads[started], bench_thread, b) !=
+		    thrd_success) {
+			fprintf(stderr, "could not create a thread\n");
+			failed = true;
+			break;
+		}
+	}
+	for (unsigned i = 0; i < started; i++) {
+		int res;
+
+		if (thrd_join(threads[i], &res) != thrd_success || res)
+			failed = true;
+	}
+
+	return failed ? 0 : MAX2(os_time_get_nano() - start, 1);
+}
+
+static void
+print_report(const struct bench *b, unsigned num_threads, uint64_t wall_ns)
+{
+	struct rusage usage;
+	unsigned compiled = 0;
+
+	printf("%-6s %8s %12s %12s %12s\n",
+	       "stage", "shaders", "total ms", "mean us", "max us");
+
+	for (unsigned stage = 0; stage < PIPE_SHADER_TYPES; stage++) {
+		uint64_t total = 0, max = 0;
+		unsigned count = 0;
+
+		for (unsigned i = 0; i < b->num_shaders; i++) {
+			const struct shader *s = &b->shaders[i];
+
+			if (s->stage != stage || s->skip)
+				continue;
+
+			total += s->best_ns;
+			max = MAX2(max, s->best_ns);
+			count++;
+		}
+
+		if (!count)
+			continue;
+
+		printf("%-6s %8u %12.2f %12.2f %12.2f\n",
+		       tgsi_processor_type_names[stage], count, total / 1e6,
+		       total / 1e3 / count, max / 1e3);
+		compiled += count;
+	}
+
+	getrusage(RUSAGE_SELF, &usage);
+
+	printf("\n%u shaders x %u iterations on %u threads in %.2f ms: "
+	       "%.1f compiles/s, peak RSS %ld MB\n",
+	       compiled, b->iterations, num_threads, wall_ns / 1e6,
+	       compiled * b->iterations / (wall_ns / 1e9),
+	       usage.ru_maxrss / 1024);
+}
+
+static void
+write_results(const struct bench *b, const char *path)
+{
+	FILE *f = fopen(path, "w");
+
+	if (!f) {
+		fprintf(stderr, "could not write %s\n", path);
+		return;
+	}
+
+	for (unsigned i = 0; i < b->num_shaders; i++) {
+		const struct shader *s = &b->shaders[i];
+
+		if (!s->skip)
+			fprintf(f, "%s %s %" PRIu64 "\n", s->name,
+				tgsi_processor_type_names[s->stage], s->best_ns);
+	}
+
+	fclose(f);
+}
+
+/*
+ * Compares against the results of an earlier run, in the same spirit as
+ * shader-db's report.py: totals over the shaders found in both runs, and
+ * each shader whose compile time changed by more than threshold percent.
+ */
+static void
+compare_results(const struct bench *b, const char *path, double threshold)
+{
+	struct hash_table *before;
+	char name[4096], stage[16];
+	uint64_t total_before = 0, total_after = 0;
+	unsigned helped = 0, hurt = 0, common = 0;
+	uint64_t ns;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f) {
+		fprintf(stderr, "could not read %s\n", path);
+		return;
+	}
+
+	before = _mesa_hash_table_create(NULL, _mesa_hash_string,
+					 _mesa_key_string_equal);
+
+	while (fscanf(f, "%4095s %15s %" SCNu64, name, stage, &ns) == 3) {
+		uint64_t *data = ralloc(before, uint64_t);
+		*data = ns;
+		_mesa_hash_table_insert(before, ralloc_strdup(before, name), data);
+	}
+	fclose(f);
+
+	printf("\n");
+	for (unsigned i = 0; i < b->num_shaders; i++) {
+		const struct shader *s = &b->shaders[i];
+		struct hash_entry *entry;
+		uint64_t old_ns;
+		double change;
+
+		entry = _mesa_hash_table_search(before, s->name);
+		if (!entry || s->skip)
+			continue;
+
+		old_ns = *(uint64_t *)entry->data;
+		change = old_ns ? 100.0 * ((double)s->best_ns - old_ns) / old_ns : 0;
+
+		total_before += old_ns;
+		total_after += s->best_ns;
+		common++;
+
+		if (change > threshold) {
+			hurt++;
+		} else if (change < -threshold) {
+			helped++;
+		} else {
+			continue;
+		}
+
+		printf("%s: %.2f -> %.2f us (%+.2f%%)\n", s->name,
+		       old_ns / 1e3, s->best_ns / 1e3, change);
+	}
+
+	printf("\ntotal compile time in shared programs: %.2f -> %.2f ms "
+	       "(%+.2f%%)\n", total_before / 1e6, total_after / 1e6,
+	       total_before ?
+	       100.0 * ((double)total_after - total_before) / total_before : 0);
+	printf("shaders in common: %u, helped: %u, hurt: %u "
+	       "(threshold %.1f%%)\n", common, helped, hurt, threshold);
+
+	_mesa_hash_table_destroy(before, NULL);
+}
+
+static void
+print_usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [OPTIONS]... FILE|DIRECTORY...\n"
+		"\n"
+		"Compiles TGSI text shaders (*.tgsi files when given a directory)\n"
+		"with the first device found, or the one selected with -d.\n"
+		"\n"
+		"  -j N         use N threads (default: one per CPU)\n"
+		"  -n N         compile every shader N times, each time on a new\n"
+		"               screen, keeping the fastest (default: 3)\n"
+		"  -d DRIVER    use the device handled by DRIVER, e.g. iris\n"
+		"  -o FILE      write per shader results to FILE\n"
+		"  -c FILE      compare against results written with -o\n"
+		"  -t PERCENT   threshold for listing shaders with -c (default: 5)\n"
+		"  -h           show this message\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	struct pipe_loader_device **devs;
+	struct bench b = { .iterations = 3 };
+	const char *driver = NULL, *output = NULL, *baseline = NULL;
+	unsigned num_threads = 0, skipped = 0;
+	double threshold = 5.0;
+	uint64_t wall_ns = 0;
+	thrd_t *threads;
+	int num_devs, c, ret = 0;
+
+	while ((c = getopt(argc, argv, "j:n:d:o:c:t:h")) != -1) {
+		switch (c) {
+		case 'j':
+			num_threads = atoi(optarg);
+			break;
+		case 'n':
+			b.iterations = MAX2(atoi(optarg), 1);
+			break;
+		case 'd':
+			driver = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'c':
+			baseline = optarg;
+			break;
+		case 't':
+			threshold = atof(optarg);
+			break;
+		default:
+			print_usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind >= argc) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (!num_threads) {
+		util_cpu_detect();
+		num_threads = util_cpu_caps.nr_cpus;
+	}
+
+	/* Time compiles, not shader cache lookups: */
+	setenv("MESA_GLSL_CACHE_DISABLE", "true", 1);
+
+	num_devs = pipe_loader_probe(NULL, 0);
+	devs = CALLOC(num_devs, sizeof(*devs));
+	num_devs = pipe_loader_probe(devs, num_devs);
+	for (int i = 0; i < num_devs && !b.dev; i++) {
+		if (!driver || !strcmp(devs[i]->driver_name, driver))
+			b.dev = devs[i];
+	}
+
+	if (!b.dev || !(b.screen = pipe_loader_create_screen(b.dev))) {
+		fprintf(stderr, "no %s%sdevice found\n",
+			driver ? driver : "", driver ? " " : "");
+		return 1;
+	}
+
+	for (int i = optind; i < argc; i++)
+		add_path(&b, argv[i]);
+
+	if (!b.num_shaders) {
+		fprintf(stderr, "no shaders found\n");
+		return 1;
+	}
+
+	qsort(b.shaders, b.num_shaders, sizeof(*b.shaders), compare_names);
+
+	for (unsigned i = 0; i < b.num_shaders; i++) {
+		struct shader *s = &b.shaders[i];
+
+		s->skip = !stage_supported(b.screen, s->stage);
+		skipped += s->skip;
+	}
+	if (skipped) {
+		fprintf(stderr, "skipping %u shaders for stages %s doesn't "
+			"support\n", skipped, b.dev->driver_name);
+	}
+
+	printf("%s: %s, %u shaders\n\n", b.dev->driver_name,
+	       b.screen->get_name(b.screen), b.num_shaders);
+
+	threads = CALLOC(num_threads, sizeof(*threads));
+	for (unsigned i = 0; i < b.iterations; i++) {
+		uint64_t ns;
+
+		/* A new screen drops whatever the driver cached in memory
+		 * during the previous iteration:
+		 */
+		if (!b.screen && !(b.screen = pipe_loader_create_screen(b.dev))) {
+			fprintf(stderr, "could not create a screen\n");
+			ret = 1;
+			break;
+		}
+
+		ns = run_iteration(&b, threads, num_threads);
+
+		b.screen->destroy(b.screen);
+		b.screen = NULL;
+
+		if (!ns) {
+			ret = 1;
+			break;
+		}
+		wall_ns += ns;
+	}
+
+	if (!ret) {
+		print_report(&b, num_threads, wall_ns);
+
+		if (output)
+			write_results(&b, output);
+		if (baseline)
+			compare_results(&b, baseline, threshold);
+	}
+
+	for (unsigned i = 0; i < b.num_shaders; i++) {
+		free(b.shaders[i].name);
+		FREE(b.shaders[i].tokens);
+	}
+	free(b.shaders);
+	FREE(threads);
+
+	pipe_loader_release(devs, num_devs);
+	FREE(devs);
+
+	return ret;
+}
@@ -594,6 +594,83 @@ gen_spec_init(void)
    return spec;
 }
 
+/* Instruction opcodes only ever use bits 16..31 of the header DWord (see
+ * end_element()). gen_spec_find_instruction() looks them up in a two-level
+ * table: the first level is indexed by header bits 23..31 (command type and
+ * the upper opcode bits) and is NULL where no instruction can match, the
+ * second by bits 16..22.
+ */
+#define COMMAND_TABLE_L1_SHIFT 23
+#define COMMAND_TABLE_L1_SIZE  (1 << (32 - COMMAND_TABLE_L1_SHIFT))
+#define COMMAND_TABLE_L2_SHIFT 16
+#define COMMAND_TABLE_L2_SIZE  (1 << (COMMAND_TABLE_L1_SHIFT - COMMAND_TABLE_L2_SHIFT))
+
+struct gen_command_list {
+   struct gen_group **commands;
+   uint32_t count;
+};
+
+static void
+gen_spec_build_command_table(struct gen_spec *spec)
+{
+   uint32_t n_commands = _mesa_hash_table_num_entries(spec->commands);
+   struct gen_group **commands =
+      ralloc_array(NULL, struct gen_group *, n_commands);
+   struct gen_group **candidates =
+      ralloc_array(commands, struct gen_group *, n_commands);
+   struct gen_group **matches =
+      ralloc_array(commands, struct gen_group *, n_commands);
+   uint32_t n = 0;
+
+   /* Lists keep the commands in hash table order, so that lookups return
+    * the same instruction as walking the hash table would.
+    */
+   hash_table_foreach(spec->commands, entry)
+      commands[n++] = entry->data;
+
+   spec->command_table = rzalloc_array(spec, struct gen_command_list *,
+                                       COMMAND_TABLE_L1_SIZE);
+
+   for (uint32_t i = 0; i < COMMAND_TABLE_L1_SIZE; i++) {
+      const uint32_t l1_mask = ~0u << COMMAND_TABLE_L1_SHIFT;
+      uint32_t header = i << COMMAND_TABLE_L1_SHIFT;
+      uint32_t n_candidates = 0;
+
+      for (uint32_t c = 0; c < n_commands; c++) {
+         if (((header ^ commands[c]->opcode) &
+              commands[c]->opcode_mask & l1_mask) == 0)
+            candidates[n_candidates++] = commands[c];
+      }
+
+      if (n_candidates == 0)
+         continue;
+
+      struct gen_command_list *lists =
+         rzalloc_array(spec, struct gen_command_list, COMMAND_TABLE_L2_SIZE);
+
+      for (uint32_t j = 0; j < COMMAND_TABLE_L2_SIZE; j++) {
+         uint32_t n_matches = 0;
+
+         header = (i << COMMAND_TABLE_L1_SHIFT) | (j << COMMAND_TABLE_L2_SHIFT);
+         for (uint32_t c = 0; c < n_candidates; c++) {
+            if ((header & candidates[c]->opcode_mask) == candidates[c]->opcode)
+               matches[n_matches++] = candidates[c];
+         }
+
+         if (n_matches == 0)
+            continue;
+
+         lists[j].commands = ralloc_array(lists, struct gen_group *, n_matches);
+         memcpy(lists[j].commands, matches, n_matches * sizeof(*matches));
+         lists[j].count = n_matches;
+      }
+
+      spec->command_table[i] = lists;
+   }
+
+   ralloc_free(commands);
+}
+
 struct gen_spec *
 gen_spec_load(const struct gen_device_info *devinfo)
 {
@@ -657,6 +734,8 @@ gen_spec_load(const struct gen_device_info *devinfo)
    XML_ParserFree(ctx.parser);
    free(text_data);
 
+   gen_spec_build_command_table(ctx.spec);
+
    return ctx.spec;
 }
 
@@ -731,6 +810,9 @@ gen_spec_load_filename(const char *filename)
       return NULL;
    }
 
+   if (ctx.spec)
+      gen_spec_build_command_table(ctx.spec);
+
    return ctx.spec;
 }
 
@@ -761,11 +843,16 @@ gen_spec_find_instruction(struct gen_spec *spec,
                           enum drm_i915_gem_engine_class engine,
                           const uint32_t *p)
 {
-   hash_table_foreach(spec->commands, entry) {
-      struct gen_group *command = entry->data;
-      uint32_t opcode = *p & command->opcode_mask;
-      if ((command->engine_mask & I915_ENGINE_CLASS_TO_MASK(engine)) &&
-           opcode == command->opcode)
+   const struct gen_command_list *lists =
+      spec->command_table[*p >> COMMAND_TABLE_L1_SHIFT];
+   if (lists == NULL)
+      return NULL;
+
+   const struct gen_command_list *list =
+      &lists[(*p >> COMMAND_TABLE_L2_SHIFT) & (COMMAND_TABLE_L2_SIZE - 1)];
+   for (uint32_t i = 0; i < list->count; i++) {
+      struct gen_group *command = list->commands[i];
+      if (command->engine_mask & I915_ENGINE_CLASS_TO_MASK(engine))
          return command;
    }
 
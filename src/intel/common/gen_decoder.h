@@ -107,6 +107,9 @@ struct gen_spec {
    struct hash_table *enums;
 
    struct hash_table *access_cache;
+
+   /* Instructions by opcode, see gen_spec_find_instruction() */
+   struct gen_command_list **command_table;
 };
 
 struct gen_group {
@@ -36,6 +36,148 @@
 #include "isl_gen12.h"
 #include "isl_priv.h"
 
+#include "util/u_cpu_detect.h"
+#include "util/u_math.h"
+#include "util/u_parallel.h"
+
+typedef void (*isl_linear_to_tiled_fn)(uint32_t xt1, uint32_t xt2,
+                                       uint32_t yt1, uint32_t yt2,
+                                       char *dst, const char *src,
+                                       uint32_t dst_pitch, int32_t src_pitch,
+                                       bool has_swizzling,
+                                       enum isl_tiling tiling,
+                                       isl_memcpy_type copy_type);
+
+typedef void (*isl_tiled_to_linear_fn)(uint32_t xt1, uint32_t xt2,
+                                       uint32_t yt1, uint32_t yt2,
+                                       char *dst, const char *src,
+                                       int32_t dst_pitch, uint32_t src_pitch,
+                                       bool has_swizzling,
+                                       enum isl_tiling tiling,
+                                       isl_memcpy_type copy_type);
+
+/* Copies are split in bands of tile rows moving at least this many bytes,
+ * smaller copies stay on the calling thread.
+ */
+#define ISL_MEMCPY_MIN_BYTES_PER_JOB (512 * 1024)
+
+static isl_linear_to_tiled_fn
+choose_linear_to_tiled(isl_memcpy_type copy_type)
+{
+#if defined(USE_AVX512) || defined(USE_AVX2)
+   util_cpu_detect();
+#endif
+
+#ifdef USE_AVX512
+   if (util_cpu_caps.has_avx512f && util_cpu_caps.has_avx512bw)
+      return _isl_memcpy_linear_to_tiled_avx512;
+#endif
+#ifdef USE_AVX2
+   if (util_cpu_caps.has_avx2)
+      return _isl_memcpy_linear_to_tiled_avx2;
+#endif
+#ifdef USE_SSE41
+   if (copy_type == ISL_MEMCPY_STREAMING_LOAD)
+      return _isl_memcpy_linear_to_tiled_sse41;
+#endif
+
+   return _isl_memcpy_linear_to_tiled;
+}
+
+static isl_tiled_to_linear_fn
+choose_tiled_to_linear(isl_memcpy_type copy_type)
+{
+#if defined(USE_AVX512) || defined(USE_AVX2)
+   util_cpu_detect();
+#endif
+
+#ifdef USE_AVX512
+   if (util_cpu_caps.has_avx512f && util_cpu_caps.has_avx512bw)
+      return _isl_memcpy_tiled_to_linear_avx512;
+#endif
+#ifdef USE_AVX2
+   if (util_cpu_caps.has_avx2)
+      return _isl_memcpy_tiled_to_linear_avx2;
+#endif
+#ifdef USE_SSE41
+   if (copy_type == ISL_MEMCPY_STREAMING_LOAD)
+      return _isl_memcpy_tiled_to_linear_sse41;
+#endif
+
+   return _isl_memcpy_tiled_to_linear;
+}
+
+struct isl_memcpy_bands {
+   isl_linear_to_tiled_fn linear_to_tiled;
+   isl_tiled_to_linear_fn tiled_to_linear;
+   uint32_t xt1, xt2;
+   uint32_t yt0, yt1, yt2;
+   uint32_t tile_h;
+   char *dst;
+   const char *src;
+   int32_t linear_pitch;
+   uint32_t tiled_pitch;
+   bool has_swizzling;
+   enum isl_tiling tiling;
+   isl_memcpy_type copy_type;
+};
+
+static void
+isl_memcpy_tile_rows(void *data, unsigned first_row, unsigned num_rows)
+{
+   const struct isl_memcpy_bands *b = data;
+   uint32_t y1 = MAX2(b->yt1, b->yt0 + first_row * b->tile_h);
+   uint32_t y2 = MIN2(b->yt2, b->yt0 + (first_row + num_rows) * b->tile_h);
+
+   /* Only the linear side is addressed relative to (xt1, yt1). */
+   ptrdiff_t linear_offset = (ptrdiff_t)(y1 - b->yt1) * b->linear_pitch;
+
+   if (b->linear_to_tiled) {
+      b->linear_to_tiled(b->xt1, b->xt2, y1, y2,
+                         b->dst, b->src + linear_offset,
+                         b->tiled_pitch, b->linear_pitch,
+                         b->has_swizzling, b->tiling, b->copy_type);
+   } else {
+      b->tiled_to_linear(b->xt1, b->xt2, y1, y2,
+                         b->dst + linear_offset, b->src,
+                         b->linear_pitch, b->tiled_pitch,
+                         b->has_swizzling, b->tiling, b->copy_type);
+   }
+}
+
+/**
+ * Run the copy described by \p b, spreading bands of whole tile rows over
+ * the image thread pool when it is large enough to be worth it.
+ */
+static void
+isl_memcpy_run_bands(struct isl_memcpy_bands *b)
+{
+   switch (b->tiling) {
+   case ISL_TILING_X:
+      b->tile_h = 8;
+      break;
+   case ISL_TILING_Y0:
+      b->tile_h = 32;
+      break;
+   default:
+      /* Let the copy functions complain about it. */
+      b->tile_h = b->yt2 - b->yt1;
+      break;
+   }
+
+   if (b->yt2 <= b->yt1 || b->xt2 <= b->xt1) {
+      isl_memcpy_tile_rows(b, 0, 1);
+      return;
+   }
+
+   b->yt0 = ROUND_DOWN_TO(b->yt1, b->tile_h);
+   unsigned num_rows = DIV_ROUND_UP(b->yt2 - b->yt0, b->tile_h);
+   uint64_t row_bytes = (uint64_t)(b->xt2 - b->xt1) * b->tile_h;
+   unsigned min_rows = DIV_ROUND_UP(ISL_MEMCPY_MIN_BYTES_PER_JOB, row_bytes);
+
+   util_parallel_rows(num_rows, min_rows, isl_memcpy_tile_rows, b);
+}
+
 void
 isl_memcpy_linear_to_tiled(uint32_t xt1, uint32_t xt2,
                            uint32_t yt1, uint32_t yt2,
@@ -45,18 +187,20 @@ isl_memcpy_linear_to_tiled(uint32_t xt1, uint32_t xt2,
                            enum isl_tiling tiling,
                            isl_memcpy_type copy_type)
 {
-#ifdef USE_SSE41
-   if (copy_type == ISL_MEMCPY_STREAMING_LOAD) {
-      _isl_memcpy_linear_to_tiled_sse41(
-         xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
-         tiling, copy_type);
-      return;
-   }
-#endif
+   struct isl_memcpy_bands bands = {
+      .linear_to_tiled = choose_linear_to_tiled(copy_type),
+      .xt1 = xt1, .xt2 = xt2,
+      .yt1 = yt1, .yt2 = yt2,
+      .dst = dst,
+      .src = src,
+      .linear_pitch = src_pitch,
+      .tiled_pitch = dst_pitch,
+      .has_swizzling = has_swizzling,
+      .tiling = tiling,
+      .copy_type = copy_type,
+   };
 
-   _isl_memcpy_linear_to_tiled(
-      xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
-      tiling, copy_type);
+   isl_memcpy_run_bands(&bands);
 }
 
 void
@@ -68,18 +212,20 @@ isl_memcpy_tiled_to_linear(uint32_t xt1, uint32_t xt2,
                            enum isl_tiling tiling,
                            isl_memcpy_type copy_type)
 {
-#ifdef USE_SSE41
-   if (copy_type == ISL_MEMCPY_STREAMING_LOAD) {
-      _isl_memcpy_tiled_to_linear_sse41(
-         xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
-         tiling, copy_type);
-      return;
-   }
-#endif
+   struct isl_memcpy_bands bands = {
+      .tiled_to_linear = choose_tiled_to_linear(copy_type),
+      .xt1 = xt1, .xt2 = xt2,
+      .yt1 = yt1, .yt2 = yt2,
+      .dst = dst,
+      .src = src,
+      .linear_pitch = dst_pitch,
+      .tiled_pitch = src_pitch,
+      .has_swizzling = has_swizzling,
+      .tiling = tiling,
+      .copy_type = copy_type,
+   };
 
-   _isl_memcpy_tiled_to_linear(
-      xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
-      tiling, copy_type);
+   isl_memcpy_run_bands(&bands);
 }
 
 void PRINTFLIKE(3, 4) UNUSED
@@ -36,7 +36,9 @@
 
 #include "isl_priv.h"
 
-#if defined(__SSSE3__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
 #include <tmmintrin.h>
 #elif defined(__SSE2__)
 #include <emmintrin.h>
@@ -120,6 +122,29 @@ rgba8_copy_16_aligned_src(void *dst, const void *src)
                                      *(__m128i *)rgba8_permutation));
 }
 
+#if defined(__AVX512BW__)
+static inline void
+rgba8_copy_64(void *dst, const void *src)
+{
+   const __m512i perm =
+      _mm512_broadcast_i32x4(_mm_loadu_si128((__m128i *)rgba8_permutation));
+
+   _mm512_storeu_si512(dst, _mm512_shuffle_epi8(_mm512_loadu_si512(src), perm));
+}
+#elif defined(__AVX2__)
+static inline void
+rgba8_copy_64(void *dst, const void *src)
+{
+   const __m256i perm =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i *)rgba8_permutation));
+
+   _mm256_storeu_si256(dst,
+                       _mm256_shuffle_epi8(_mm256_loadu_si256(src), perm));
+   _mm256_storeu_si256(dst + 32,
+                       _mm256_shuffle_epi8(_mm256_loadu_si256(src + 32), perm));
+}
+#endif
+
 #elif defined(__SSE2__)
 static inline void
 rgba8_copy_16_aligned_dst(void *dst, const void *src)
@@ -164,6 +189,13 @@ rgba8_copy_aligned_dst(void *dst, const void *src, size_t bytes)
 {
    assert(bytes == 0 || !(((uintptr_t)dst) & 0xf));
 
+#if defined(__AVX2__)
+   if (bytes == 64) {
+      rgba8_copy_64(dst, src);
+      return dst;
+   }
+#endif
+
 #if defined(__SSSE3__) || defined(__SSE2__)
    if (bytes == 64) {
       rgba8_copy_16_aligned_dst(dst +  0, src +  0);
@@ -194,6 +226,13 @@ rgba8_copy_aligned_src(void *dst, const void *src, size_t bytes)
 {
    assert(bytes == 0 || !(((uintptr_t)src) & 0xf));
 
+#if defined(__AVX2__)
+   if (bytes == 64) {
+      rgba8_copy_64(dst, src);
+      return dst;
+   }
+#endif
+
 #if defined(__SSSE3__) || defined(__SSE2__)
    if (bytes == 64) {
       rgba8_copy_16_aligned_src(dst +  0, src +  0);
@@ -578,6 +617,16 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128((__m128i *)dest, val);
       return dest;
    } else if (count == 64) {
+#if defined(__AVX512F__)
+      _mm512_storeu_si512(dest, _mm512_stream_load_si512((void *)src));
+      return dest;
+#elif defined(__AVX2__)
+      __m256i val0 = _mm256_stream_load_si256(((__m256i *)src) + 0);
+      __m256i val1 = _mm256_stream_load_si256(((__m256i *)src) + 1);
+      _mm256_storeu_si256(((__m256i *)dest) + 0, val0);
+      _mm256_storeu_si256(((__m256i *)dest) + 1, val1);
+      return dest;
+#else
       __m128i val0 = _mm_stream_load_si128(((__m128i *)src) + 0);
       __m128i val1 = _mm_stream_load_si128(((__m128i *)src) + 1);
       __m128i val2 = _mm_stream_load_si128(((__m128i *)src) + 2);
@@ -587,6 +636,7 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128(((__m128i *)dest) + 2, val2);
       _mm_storeu_si128(((__m128i *)dest) + 3, val3);
       return dest;
+#endif
    } else {
       assert(count < 64); /* and (count < 16) for ytiled */
       return memcpy(dest, src, count);
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2020 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks every tiled memcpy variant the CPU supports, and the threaded
+ * entry points, against a per-byte reference implementation of the X and
+ * Y tile layouts.
+ *
+ * Run with "bench" as the only argument to print the throughput of each
+ * variant on a 16MB surface instead.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "isl/isl.h"
+#include "isl/isl_priv.h"
+#include "util/os_time.h"
+#include "util/u_cpu_detect.h"
+
+// An asssert that works regardless of NDEBUG.
+#define t_assert(cond) \
+   do { \
+      if (!(cond)) { \
+         fprintf(stderr, "%s:%d: assertion failed\n", __FILE__, __LINE__); \
+         abort(); \
+      } \
+   } while (0)
+
+typedef void (*linear_to_tiled_fn)(uint32_t xt1, uint32_t xt2,
+                                   uint32_t yt1, uint32_t yt2,
+                                   char *dst, const char *src,
+                                   uint32_t dst_pitch, int32_t src_pitch,
+                                   bool has_swizzling,
+                                   enum isl_tiling tiling,
+                                   isl_memcpy_type copy_type);
+
+typedef void (*tiled_to_linear_fn)(uint32_t xt1, uint32_t xt2,
+                                   uint32_t yt1, uint32_t yt2,
+                                   char *dst, const char *src,
+                                   int32_t dst_pitch, uint32_t src_pitch,
+                                   bool has_swizzling,
+                                   enum isl_tiling tiling,
+                                   isl_memcpy_type copy_type);
+
+struct variant {
+   const char *name;
+   linear_to_tiled_fn linear_to_tiled;
+   tiled_to_linear_fn tiled_to_linear;
+   bool streaming_load;
+};
+
+static struct variant variants[8];
+static unsigned num_variants;
+
+static void
+add_variant(const char *name, linear_to_tiled_fn linear_to_tiled,
+            tiled_to_linear_fn tiled_to_linear, bool streaming_load)
+{
+   variants[num_variants++] = (struct variant) {
+      name, linear_to_tiled, tiled_to_linear, streaming_load,
+   };
+}
+
+static void
+init_variants(void)
+{
+   util_cpu_detect();
+
+#ifdef USE_SSE41
+   add_variant("threaded", isl_memcpy_linear_to_tiled,
+               isl_memcpy_tiled_to_linear, util_cpu_caps.has_sse4_1);
+#else
+   add_variant("threaded", isl_memcpy_linear_to_tiled,
+               isl_memcpy_tiled_to_linear, false);
+#endif
+   add_variant("normal", _isl_memcpy_linear_to_tiled,
+               _isl_memcpy_tiled_to_linear, false);
+#ifdef USE_SSE41
+   if (util_cpu_caps.has_sse4_1)
+      add_variant("sse41", _isl_memcpy_linear_to_tiled_sse41,
+                  _isl_memcpy_tiled_to_linear_sse41, true);
+#endif
+#ifdef USE_AVX2
+   if (util_cpu_caps.has_avx2)
+      add_variant("avx2", _isl_memcpy_linear_to_tiled_avx2,
+                  _isl_memcpy_tiled_to_linear_avx2, true);
+#endif
+#ifdef USE_AVX512
+   if (util_cpu_caps.has_avx512f && util_cpu_caps.has_avx512bw)
+      add_variant("avx512", _isl_memcpy_linear_to_tiled_avx512,
+                  _isl_memcpy_tiled_to_linear_avx512, true);
+#endif
+}
+
+/* Byte offset of (x, y) in a tiled surface, with x in bytes. */
+static uint32_t
+tiled_offset(enum isl_tiling tiling, bool swizzling, uint32_t pitch,
+             uint32_t x, uint32_t y)
+{
+   uint32_t offset;
+
+   if (tiling == ISL_TILING_X) {
+      offset = (y / 8) * pitch * 8 + (x / 512) * 4096 +
+               (y % 8) * 512 + x % 512;
+      if (swizzling)
+         offset ^= ((offset >> 3) ^ (offset >> 4)) & (1 << 6);
+   } else {
+      offset = (y / 32) * pitch * 32 + (x / 128) * 4096 +
+               ((x % 128) / 16) * 512 + (y % 32) * 16 + x % 16;
+      if (swizzling)
+         offset ^= (offset >> 3) & (1 << 6);
+   }
+
+   return offset;
+}
+
+/* Linear byte stored at linear byte x for a given copy type. */
+static uint32_t
+swapped_x(isl_memcpy_type copy_type, uint32_t x)
+{
+   if (copy_type != ISL_MEMCPY_BGRA8)
+      return x;
+
+   switch (x % 4) {
+   case 0: return x + 2;
+   case 2: return x - 2;
+   default: return x;
+   }
+}
+
+#define TEST_PITCH 2048
+#define TEST_HEIGHT 1024
+
+static void
+test_variant(const struct variant *v, enum isl_tiling tiling, bool swizzling,
+             isl_memcpy_type copy_type)
+{
+   const uint32_t size = TEST_PITCH * TEST_HEIGHT;
+   uint8_t *linear = aligned_alloc(64, size);
+   uint8_t *tiled = aligned_alloc(64, size);
+   uint8_t *result = aligned_alloc(64, size);
+
+   /* Not aligned to anything but the 4 byte pixels BGRA8 needs. */
+   const uint32_t x1 = 36, x2 = TEST_PITCH - 20;
+   const uint32_t y1 = 3, y2 = TEST_HEIGHT - 5;
+
+   for (uint32_t i = 0; i < size; i++) {
+      linear[i] = rand();
+      tiled[i] = rand();
+   }
+
+   if (copy_type != ISL_MEMCPY_STREAMING_LOAD) {
+      memcpy(result, tiled, size);
+      v->linear_to_tiled(x1, x2, y1, y2, (char *)result,
+                         (char *)linear + y1 * TEST_PITCH + x1,
+                         TEST_PITCH, TEST_PITCH, swizzling, tiling,
+                         copy_type);
+
+      for (uint32_t y = 0; y < TEST_HEIGHT; y++) {
+         for (uint32_t x = 0; x < TEST_PITCH; x++) {
+            uint32_t offset = tiled_offset(tiling, swizzling, TEST_PITCH, x, y);
+            bool inside = x >= x1 && x < x2 && y >= y1 && y < y2;
+            uint8_t expected = inside ?
+               linear[y * TEST_PITCH + swapped_x(copy_type, x)] :
+               tiled[offset];
+            t_assert(result[offset] == expected);
+         }
+      }
+   }
+
+   memcpy(result, linear, size);
+   v->tiled_to_linear(x1, x2, y1, y2,
+                      (char *)result + y1 * TEST_PITCH + x1, (char *)tiled,
+                      TEST_PITCH, TEST_PITCH, swizzling, tiling, copy_type);
+
+   for (uint32_t y = 0; y < TEST_HEIGHT; y++) {
+      for (uint32_t x = 0; x < TEST_PITCH; x++) {
+         bool inside = x >= x1 && x < x2 && y >= y1 && y < y2;
+         uint8_t expected = inside ?
+            tiled[tiled_offset(tiling, swizzling, TEST_PITCH,
+                               swapped_x(copy_type, x), y)] :
+            linear[y * TEST_PITCH + x];
+         t_assert(result[y * TEST_PITCH + x] == expected);
+      }
+   }
+
+   free(linear);
+   free(tiled);
+   free(result);
+}
+
+static void
+run_tests(void)
+{
+   static const enum isl_tiling tilings[] = { ISL_TILING_X, ISL_TILING_Y0 };
+   static const isl_memcpy_type copy_types[] = {
+      ISL_MEMCPY, ISL_MEMCPY_BGRA8, ISL_MEMCPY_STREAMING_LOAD,
+   };
+
+   for (unsigned v = 0; v < num_variants; v++) {
+      for (unsigned t = 0; t < ARRAY_SIZE(tilings); t++) {
+         for (unsigned c = 0; c < ARRAY_SIZE(copy_types); c++) {
+            if (copy_types[c] == ISL_MEMCPY_STREAMING_LOAD &&
+                !variants[v].streaming_load)
+               continue;
+
+            test_variant(&variants[v], tilings[t], false, copy_types[c]);
+            test_variant(&variants[v], tilings[t], true, copy_types[c]);
+         }
+      }
+   }
+}
+
+#define BENCH_PITCH 8192
+#define BENCH_HEIGHT 2048
+#define BENCH_ITERATIONS 32
+
+static void
+run_bench(void)
+{
+   static const struct {
+      const char *name;
+      enum isl_tiling tiling;
+   } tilings[] = {
+      { "X", ISL_TILING_X },
+      { "Y", ISL_TILING_Y0 },
+   };
+   const uint32_t size = BENCH_PITCH * BENCH_HEIGHT;
+   char *linear = aligned_alloc(64, size);
+   char *tiled = aligned_alloc(64, size);
+
+   memset(linear, 1, size);
+   memset(tiled, 2, size);
+
+   printf("%-10s %-6s %14s %14s %14s\n", "variant", "tiling",
+          "to tiled GB/s", "to linear GB/s", "streaming GB/s");
+
+   for (unsigned v = 0; v < num_variants; v++) {
+      const struct variant *var = &variants[v];
+
+      for (unsigned t = 0; t < ARRAY_SIZE(tilings); t++) {
+         double gbps[3] = { 0 };
+
+         for (unsigned i = 0; i < 3; i++) {
+            if (i == 2 && !var->streaming_load)
+               continue;
+
+            int64_t start = os_time_get_nano();
+            for (unsigned n = 0; n < BENCH_ITERATIONS; n++) {
+               if (i == 0) {
+                  var->linear_to_tiled(0, BENCH_PITCH, 0, BENCH_HEIGHT,
+                                       tiled, linear,
+                                       BENCH_PITCH, BENCH_PITCH, false,
+                                       tilings[t].tiling, ISL_MEMCPY);
+               } else {
+                  var->tiled_to_linear(0, BENCH_PITCH, 0, BENCH_HEIGHT,
+                                       linear, tiled,
+                                       BENCH_PITCH, BENCH_PITCH, false,
+                                       tilings[t].tiling,
+                                       i == 2 ? ISL_MEMCPY_STREAMING_LOAD :
+                                                ISL_MEMCPY);
+               }
+            }
+            int64_t elapsed = os_time_get_nano() - start;
+
+            gbps[i] = (double)size * BENCH_ITERATIONS / elapsed;
+         }
+
+         printf("%-10s %-6s %14.2f %14.2f %14.2f\n", var->name,
+                tilings[t].name, gbps[0], gbps[1], gbps[2]);
+      }
+   }
+
+   free(linear);
+   free(tiled);
+}
+
+int main(int argc, char **argv)
+{
+   init_variants();
+
+   if (argc > 1 && strcmp(argv[1], "bench") == 0)
+      run_bench();
+   else
+      run_tests();
+
+   return 0;
+}
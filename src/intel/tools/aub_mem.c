@@ -46,10 +46,17 @@ struct phys_mem {
    struct rb_node node;
    uint64_t fd_offset;
    uint64_t phys_addr;
+   uint64_t serial;
    uint8_t *data;
    const uint8_t *aub_data;
 };
 
+struct fd_page {
+   struct list_head link;
+   uint64_t fd_offset;
+   uint64_t serial;
+};
+
 static void
 add_gtt_bo_map(struct aub_mem *mem, struct gen_batch_decode_bo bo, bool ppgtt, bool unmap_after_use)
 {
@@ -136,6 +143,25 @@ cmp_phys_mem(const struct rb_node *node, const void *addr)
    return cmp_uint64(mem->phys_addr, *(uint64_t *)addr);
 }
 
+static uint64_t
+alloc_fd_page(struct aub_mem *mem)
+{
+   if (!list_is_empty(&mem->free_pages)) {
+      struct fd_page *page =
+         list_first_entry(&mem->free_pages, struct fd_page, link);
+      uint64_t fd_offset = page->fd_offset;
+      list_del(&page->link);
+      free(page);
+      return fd_offset;
+   }
+
+   uint64_t fd_offset = mem->mem_fd_len;
+   ASSERTED int ftruncate_res = ftruncate(mem->mem_fd, mem->mem_fd_len += 4096);
+   assert(ftruncate_res == 0);
+
+   return fd_offset;
+}
+
 static struct phys_mem *
 ensure_phys_mem(struct aub_mem *mem, uint64_t phys_addr)
 {
@@ -144,10 +170,8 @@ ensure_phys_mem(struct aub_mem *mem, uint64_t phys_addr)
    if (!node || (cmp = cmp_phys_mem(node, &phys_addr))) {
       struct phys_mem *new_mem = calloc(1, sizeof(*new_mem));
       new_mem->phys_addr = phys_addr;
-      new_mem->fd_offset = mem->mem_fd_len;
-
-      ASSERTED int ftruncate_res = ftruncate(mem->mem_fd, mem->mem_fd_len += 4096);
-      assert(ftruncate_res == 0);
+      new_mem->fd_offset = alloc_fd_page(mem);
+      new_mem->serial = mem->serial;
 
       new_mem->data = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED,
                            mem->mem_fd, new_mem->fd_offset);
@@ -160,6 +184,31 @@ ensure_phys_mem(struct aub_mem *mem, uint64_t phys_addr)
    return rb_node_data(struct phys_mem, node, node);
 }
 
+/* Give a page written for the first time since the last snapshot its own
+ * offset in mem_fd, leaving the old one untouched for the processes that
+ * still look at the snapshot.
+ */
+static void
+unshare_phys_mem(struct aub_mem *mem, struct phys_mem *pmem, bool copy)
+{
+   struct fd_page *retired = calloc(1, sizeof(*retired));
+   retired->fd_offset = pmem->fd_offset;
+   retired->serial = mem->serial;
+   list_addtail(&retired->link, &mem->retired_pages);
+
+   uint8_t *old_data = pmem->data;
+
+   pmem->fd_offset = alloc_fd_page(mem);
+   pmem->serial = mem->serial;
+   pmem->data = mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     mem->mem_fd, pmem->fd_offset);
+   assert(pmem->data != MAP_FAILED);
+
+   if (copy)
+      memcpy(pmem->data, old_data, 4096);
+   munmap(old_data, 4096);
+}
+
 static struct phys_mem *
 search_phys_mem(struct aub_mem *mem, uint64_t phys_addr)
 {
@@ -213,6 +262,8 @@ aub_mem_phys_write(void *_mem, uint64_t phys_address,
       uint64_t offset = MAX2(page, phys_address) - page;
       uint32_t size_this_page = MIN2(to_write, 4096 - offset);
       to_write -= size_this_page;
+      if (pmem->serial != mem->serial)
+         unshare_phys_mem(mem, pmem, size_this_page < 4096);
       memcpy(pmem->data + offset, data, size_this_page);
       pmem->aub_data = data - offset;
       data = (const uint8_t *)data + size_this_page;
@@ -357,12 +408,43 @@ aub_mem_get_ppgtt_bo(void *_mem, uint64_t address)
    return bo;
 }
 
+/**
+ * Freeze the current contents of physical memory.
+ *
+ * A process forked right after this call keeps seeing memory as it is now,
+ * whatever the parent writes afterwards. Returns an identifier to pass to
+ * aub_mem_release_snapshot() once that process is done.
+ */
+uint64_t
+aub_mem_snapshot(struct aub_mem *mem)
+{
+   return mem->serial++;
+}
+
+/**
+ * Release all snapshots up to and including the given one, recycling the
+ * pages only they were referencing.
+ */
+void
+aub_mem_release_snapshot(struct aub_mem *mem, uint64_t snapshot)
+{
+   list_for_each_entry_safe(struct fd_page, page, &mem->retired_pages, link) {
+      /* Pages retired at serial N are seen by the snapshots before N. */
+      if (page->serial > snapshot + 1)
+         break;
+      list_del(&page->link);
+      list_add(&page->link, &mem->free_pages);
+   }
+}
+
 bool
 aub_mem_init(struct aub_mem *mem)
 {
    memset(mem, 0, sizeof(*mem));
 
    list_inithead(&mem->maps);
+   list_inithead(&mem->retired_pages);
+   list_inithead(&mem->free_pages);
 
    mem->mem_fd = os_create_anonymous_file(0, "phys memory");
 
@@ -386,6 +468,10 @@ aub_mem_fini(struct aub_mem *mem)
       rb_tree_remove(&mem->mem, &entry->node);
       free(entry);
    }
+   list_for_each_entry_safe(struct fd_page, page, &mem->retired_pages, link)
+      free(page);
+   list_for_each_entry_safe(struct fd_page, page, &mem->free_pages, link)
+      free(page);
 
    close(mem->mem_fd);
    mem->mem_fd = -1;
@@ -46,6 +46,15 @@ struct aub_mem {
    struct list_head maps;
    struct rb_tree ggtt;
    struct rb_tree mem;
+
+   /* Copy-on-write state for aub_mem_snapshot(). Pages written after a
+    * snapshot are moved to a new offset of mem_fd, the old offsets are kept
+    * on retired_pages until the snapshots seeing them are released and then
+    * recycled through free_pages.
+    */
+   uint64_t serial;
+   struct list_head retired_pages;
+   struct list_head free_pages;
 };
 
 bool aub_mem_init(struct aub_mem *mem);
@@ -53,6 +62,9 @@ void aub_mem_fini(struct aub_mem *mem);
 
 void aub_mem_clear_bo_maps(struct aub_mem *mem);
 
+uint64_t aub_mem_snapshot(struct aub_mem *mem);
+void aub_mem_release_snapshot(struct aub_mem *mem, uint64_t snapshot);
+
 void aub_mem_phys_write(void *mem, uint64_t virt_address,
                         const void *data, uint32_t size);
 void aub_mem_ggtt_write(void *mem, uint64_t virt_address,
@@ -38,6 +38,7 @@
 #include <sys/wait.h>
 #include <sys/mman.h>
 
+#include "util/anon_file.h"
 #include "util/macros.h"
 
 #include "aub_read.h"
@@ -53,6 +54,7 @@
 static int option_full_decode = true;
 static int option_print_offsets = true;
 static int max_vbo_lines = -1;
+static int option_jobs = 1;
 static enum { COLOR_AUTO, COLOR_ALWAYS, COLOR_NEVER } option_color;
 
 /* state */
@@ -67,6 +69,123 @@ FILE *outfile;
 
 struct brw_instruction;
 
+/* When decoding with more than one job, each batch is decoded by a forked
+ * process looking at a snapshot of the memory taken at the point the batch
+ * was submitted, while the parent carries on reading the AUB file. The
+ * output of each batch goes to an anonymous file and is copied to outfile
+ * in submission order.
+ */
+struct batch_job {
+   pid_t pid;
+   int out_fd;
+   uint64_t snapshot;
+};
+
+static struct batch_job *jobs;
+static int jobs_head, jobs_count;
+static bool in_batch_job;
+
+static void
+copy_job_output(int fd)
+{
+   char buf[65536];
+   ssize_t len;
+
+   lseek(fd, 0, SEEK_SET);
+   while ((len = read(fd, buf, sizeof(buf))) > 0 ||
+          (len < 0 && errno == EINTR)) {
+      if (len > 0)
+         fwrite(buf, 1, len, outfile);
+   }
+}
+
+static void
+finish_oldest_batch_job(void)
+{
+   struct batch_job *job = &jobs[jobs_head];
+
+   int status = 0;
+   while (waitpid(job->pid, &status, 0) == -1 && errno == EINTR)
+      ;
+
+   copy_job_output(job->out_fd);
+   if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+      fprintf(stderr, "batch decode job %d failed\n", job->pid);
+
+   close(job->out_fd);
+   aub_mem_release_snapshot(&mem, job->snapshot);
+
+   jobs_head = (jobs_head + 1) % option_jobs;
+   jobs_count--;
+}
+
+static void
+finish_batch_jobs(void)
+{
+   while (jobs_count > 0)
+      finish_oldest_batch_job();
+}
+
+/* Returns true if the caller should decode the batch, either in a new job
+ * or inline when a job can't be started, and false in the parent once the
+ * job is running.
+ */
+static bool
+start_batch_job(void)
+{
+   if (option_jobs <= 1)
+      return true;
+
+   if (jobs_count == option_jobs)
+      finish_oldest_batch_job();
+
+   int out_fd = os_create_anonymous_file(0, "aubinator batch");
+   if (out_fd == -1) {
+      finish_batch_jobs();
+      return true;
+   }
+
+   uint64_t snapshot = aub_mem_snapshot(&mem);
+
+   fflush(outfile);
+   pid_t pid = fork();
+   if (pid == -1) {
+      close(out_fd);
+      aub_mem_release_snapshot(&mem, snapshot);
+      finish_batch_jobs();
+      return true;
+   }
+
+   if (pid == 0) {
+      batch_ctx.fp = fdopen(out_fd, "w");
+      if (!batch_ctx.fp)
+         _exit(EXIT_FAILURE);
+      in_batch_job = true;
+      return true;
+   }
+
+   struct batch_job *job = &jobs[(jobs_head + jobs_count) % option_jobs];
+   job->pid = pid;
+   job->out_fd = out_fd;
+   job->snapshot = snapshot;
+   jobs_count++;
+
+   /* Drop the local write views the job has inherited. */
+   aub_mem_clear_bo_maps(&mem);
+
+   return false;
+}
+
+static void
+end_batch_job(void)
+{
+   if (!in_batch_job)
+      return;
+
+   fflush(batch_ctx.fp);
+   _exit(EXIT_SUCCESS);
+}
+
 static void
 aubinator_error(void *user_data, const void *aub_data, const char *msg)
 {
@@ -142,6 +261,9 @@ static void
 handle_execlist_write(void *user_data, enum drm_i915_gem_engine_class engine, uint64_t context_descriptor)
 {
    const uint32_t pphwsp_size = 4096;
+   if (!start_batch_job())
+      return;
+
    uint32_t pphwsp_addr = context_descriptor & 0xfffff000;
    struct gen_batch_decode_bo pphwsp_bo = aub_mem_get_ggtt_bo(&mem, pphwsp_addr);
    uint32_t *context = (uint32_t *)((uint8_t *)pphwsp_bo.map +
@@ -168,6 +290,8 @@ handle_execlist_write(void *user_data, enum drm_i915_gem_engine_class engine, ui
                    MIN2(ring_buffer_tail - ring_buffer_head, ring_buffer_length),
                    ring_bo.addr + ring_buffer_head, true);
    aub_mem_clear_bo_maps(&mem);
+
+   end_batch_job();
 }
 
 static struct gen_batch_decode_bo
@@ -180,6 +304,9 @@ static void
 handle_ring_write(void *user_data, enum drm_i915_gem_engine_class engine,
                   const void *data, uint32_t data_len)
 {
+   if (!start_batch_job())
+      return;
+
    batch_ctx.user_data = &mem;
    batch_ctx.get_bo = get_legacy_bo;
 
@@ -187,12 +314,19 @@ handle_ring_write(void *user_data, enum drm_i915_gem_engine_class engine,
    gen_print_batch(&batch_ctx, data, data_len, 0, false);
 
    aub_mem_clear_bo_maps(&mem);
+
+   end_batch_job();
 }
 
+/* Parts of the file already parsed are dropped from our mapping every
+ * AUB_FILE_WINDOW bytes so that large traces don't stay resident.
+ */
+#define AUB_FILE_WINDOW (64 * 1024 * 1024)
+
 struct aub_file {
    FILE *stream;
 
-   void *map, *end, *cursor;
+   void *map, *end, *cursor, *dropped;
 };
 
 static struct aub_file *
@@ -229,12 +363,28 @@ aub_file_open(const char *filename)
 
    close(fd);
 
-   file->cursor = file->map;
+   madvise(file->map, sb.st_size, MADV_SEQUENTIAL);
+
+   file->cursor = file->dropped = file->map;
    file->end = file->map + sb.st_size;
 
    return file;
 }
 
+static void
+aub_file_advance(struct aub_file *file, int consumed)
+{
+   file->cursor += consumed;
+
+   /* Page contents stay reachable through the mapping, so the pointers the
+    * memory tracking keeps into the file remain valid.
+    */
+   if (file->cursor - file->dropped >= 2 * AUB_FILE_WINDOW) {
+      madvise(file->dropped, AUB_FILE_WINDOW, MADV_DONTNEED);
+      file->dropped += AUB_FILE_WINDOW;
+   }
+}
+
 static int
 aub_file_more_stuff(struct aub_file *file)
 {
@@ -280,6 +430,8 @@ print_help(const char *progname, FILE *file)
            "      --color[=WHEN]     colorize the output; WHEN can be 'auto' (default\n"
            "                         if omitted), 'always', or 'never'\n"
            "      --max-vbo-lines=N  limit the number of decoded VBO lines\n"
+           "      --jobs=N           decode up to N batches in parallel, 0 to use\n"
+           "                         one job per CPU (default: 1)\n"
            "      --no-pager         don't launch pager\n"
            "      --no-offsets       don't print instruction offsets\n"
            "      --xml=DIR          load hardware xml description from directory DIR\n",
@@ -300,6 +452,7 @@ int main(int argc, char *argv[])
       { "color",         required_argument, NULL,                          'c' },
       { "xml",           required_argument, NULL,                          'x' },
       { "max-vbo-lines", required_argument, NULL,                          'v' },
+      { "jobs",          required_argument, NULL,                          'j' },
       { NULL,            0,                 NULL,                          0 }
    };
 
@@ -338,6 +491,11 @@ int main(int argc, char *argv[])
       case 'v':
          max_vbo_lines = atoi(optarg);
          break;
+      case 'j':
+         option_jobs = atoi(optarg);
+         if (option_jobs <= 0)
+            option_jobs = MAX2(sysconf(_SC_NPROCESSORS_ONLN), 1);
+         break;
       default:
          break;
       }
@@ -363,6 +521,12 @@ int main(int argc, char *argv[])
       exit(EXIT_FAILURE);
    }
 
+   if (option_jobs > 1) {
+      jobs = calloc(option_jobs, sizeof(*jobs));
+      if (!jobs)
+         option_jobs = 1;
+   }
+
    file = aub_file_open(input_file);
    if (!file) {
       fprintf(stderr, "Unable to allocate buffer to open aub file\n");
@@ -387,9 +551,12 @@ int main(int argc, char *argv[])
    while (aub_file_more_stuff(file) &&
           (consumed = aub_read_command(&aub_read, file->cursor,
                                        file->end - file->cursor)) > 0) {
-      file->cursor += consumed;
+      aub_file_advance(file, consumed);
    }
 
+   finish_batch_jobs();
+   free(jobs);
+
    aub_mem_fini(&mem);
 
    fflush(stdout);
@@ -29,6 +29,8 @@
 #include "glformats.h"
 #include "format_pack.h"
 #include "format_unpack.h"
+#include "sse_swizzle.h"
+#include "x86/common_x86_asm.h"
 
 const mesa_array_format RGBA32_FLOAT =
    MESA_ARRAY_FORMAT(MESA_ARRAY_FORMAT_BASE_FORMAT_RGBA_VARIANTS,
@@ -1540,6 +1542,17 @@ _mesa_swizzle_and_convert(void *void_dst, enum mesa_array_format_datatype dst_ty
                                   swizzle, normalized, count))
       return;
 
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1 &&
+       dst_type == MESA_ARRAY_FORMAT_TYPE_UBYTE && num_dst_channels == 4 &&
+       src_type == MESA_ARRAY_FORMAT_TYPE_UBYTE &&
+       (num_src_channels == 3 || num_src_channels == 4)) {
+      _mesa_swizzle_ubyte_to_rgba(void_dst, void_src, num_src_channels,
+                                  swizzle, normalized ? UINT8_MAX : 1, count);
+      return;
+   }
+#endif
+
    switch (dst_type) {
    case MESA_ARRAY_FORMAT_TYPE_FLOAT:
       convert_float(void_dst, num_dst_channels, void_src, src_type,
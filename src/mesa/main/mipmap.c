@@ -41,6 +41,18 @@
 #include "util/half_float.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/format_srgb.h"
+#include "util/u_parallel.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Levels with at least this many destination texels per slice are split
+ * into bands of rows which are filtered in parallel.
+ */
+#define MIPMAP_PARALLEL_MIN_TEXELS (128 * 1024)
 
 
 /**
@@ -163,6 +175,162 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
 /*@}*/
 
 
+/**
+ * Return the mask of the bytes of a pixel of an 8-bit per channel sRGB
+ * format which hold sRGB encoded color.  These are decoded to linear
+ * before filtering and re-encoded afterwards.  The alpha (or X) byte is
+ * linear and may be at either end of the pixel, so this looks at the
+ * format's channel layout.
+ */
+static GLbitfield
+srgb_component_mask(mesa_format format, GLuint comps)
+{
+   uint8_t swizzle[4];
+   GLbitfield mask = 0;
+   GLuint i;
+
+   if (!_mesa_is_format_srgb(format))
+      return 0;
+
+   _mesa_get_format_swizzle(format, swizzle);
+
+   /* R, G and B; L and I formats replicate channel 0 */
+   for (i = 0; i < 3; i++) {
+      GLuint chan = swizzle[i];
+
+      if (chan > MESA_FORMAT_SWIZZLE_W)
+         continue;
+
+#if UTIL_ARCH_BIG_ENDIAN
+      /* packed channels are listed starting at the least significant byte */
+      if (_mesa_get_format_layout(format) == MESA_FORMAT_LAYOUT_PACKED)
+         chan = comps - 1 - chan;
+#endif
+      mask |= 1 << chan;
+   }
+
+   return mask;
+}
+
+
+/**
+ * Version of do_row() for 8-bit sRGB formats.
+ * \param srgbMask  bytes of each pixel which are sRGB encoded
+ */
+static void
+do_row_srgb(GLuint comps, GLbitfield srgbMask, GLint srcWidth,
+            const GLubyte *rowA, const GLubyte *rowB,
+            GLint dstWidth, GLubyte *dst)
+{
+   const GLuint k0 = (srcWidth == dstWidth) ? 0 : 1;
+   const GLuint colStride = (srcWidth == dstWidth) ? 1 : 2;
+   GLuint i, j, k, c;
+
+   for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+        i++, j += colStride, k += colStride) {
+      for (c = 0; c < comps; c++) {
+         const GLuint jc = j * comps + c, kc = k * comps + c;
+
+         if (srgbMask & (1 << c)) {
+            const GLfloat sum =
+               util_format_srgb_8unorm_to_linear_float(rowA[jc]) +
+               util_format_srgb_8unorm_to_linear_float(rowA[kc]) +
+               util_format_srgb_8unorm_to_linear_float(rowB[jc]) +
+               util_format_srgb_8unorm_to_linear_float(rowB[kc]);
+            dst[i * comps + c] =
+               util_format_linear_float_to_srgb_8unorm(sum * 0.25F);
+         }
+         else {
+            dst[i * comps + c] = (rowA[jc] + rowA[kc] +
+                                  rowB[jc] + rowB[kc]) / 4;
+         }
+      }
+   }
+}
+
+
+#ifdef __SSE2__
+/**
+ * SSE2 versions of the most common 2x2 box filters of do_row().  Only the
+ * minification case (srcWidth != dstWidth) is handled.  The results are
+ * bit-identical to the scalar code.
+ * \return number of destination pixels written, the caller finishes the
+ *         remainder of the row.
+ */
+static GLuint
+do_row_sse2(GLenum datatype, GLuint comps,
+            const GLvoid *srcRowA, const GLvoid *srcRowB,
+            GLuint dstWidth, GLvoid *dstRow)
+{
+   const __m128i zero = _mm_setzero_si128();
+   GLuint i = 0;
+
+   if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
+      const GLubyte *rowA = (const GLubyte *) srcRowA;
+      const GLubyte *rowB = (const GLubyte *) srcRowB;
+      GLubyte *dst = (GLubyte *) dstRow;
+
+      /* 4 source pixels from each row -> 2 dest pixels */
+      for (; i + 2 <= dstWidth; i += 2) {
+         const __m128i a = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+         const __m128i b = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+         const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero),
+                                          _mm_unpacklo_epi8(b, zero));
+         const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero),
+                                          _mm_unpackhi_epi8(b, zero));
+         const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi),
+                                           _mm_unpackhi_epi64(lo, hi));
+         const __m128i avg = _mm_srli_epi16(sum, 2);
+
+         _mm_storel_epi64((__m128i *) (dst + i * 4),
+                          _mm_packus_epi16(avg, avg));
+      }
+   }
+   else if (datatype == GL_UNSIGNED_SHORT && comps == 4) {
+      const GLushort *rowA = (const GLushort *) srcRowA;
+      const GLushort *rowB = (const GLushort *) srcRowB;
+      GLushort *dst = (GLushort *) dstRow;
+      const __m128i bias32 = _mm_set1_epi32(0x8000);
+      const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+
+      /* 2 source pixels from each row -> 1 dest pixel */
+      for (; i < dstWidth; i++) {
+         const __m128i a = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+         const __m128i b = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+         __m128i sum = _mm_add_epi32(_mm_unpacklo_epi16(a, zero),
+                                     _mm_unpackhi_epi16(a, zero));
+         sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(b, zero));
+         sum = _mm_add_epi32(sum, _mm_unpackhi_epi16(b, zero));
+
+         /* SSE2 has no unsigned 32 -> 16 bit pack, so bias into the signed
+          * range around the signed pack.
+          */
+         sum = _mm_sub_epi32(_mm_srli_epi32(sum, 2), bias32);
+         sum = _mm_xor_si128(_mm_packs_epi32(sum, sum), bias16);
+         _mm_storel_epi64((__m128i *) (dst + i * 4), sum);
+      }
+   }
+   else if (datatype == GL_FLOAT && comps == 4) {
+      const GLfloat *rowA = (const GLfloat *) srcRowA;
+      const GLfloat *rowB = (const GLfloat *) srcRowB;
+      GLfloat *dst = (GLfloat *) dstRow;
+      const __m128 quarter = _mm_set1_ps(0.25F);
+
+      /* same summation order as the scalar code */
+      for (; i < dstWidth; i++) {
+         __m128 sum = _mm_add_ps(_mm_loadu_ps(rowA + i * 8),
+                                 _mm_loadu_ps(rowA + i * 8 + 4));
+         sum = _mm_add_ps(sum, _mm_loadu_ps(rowB + i * 8));
+         sum = _mm_add_ps(sum, _mm_loadu_ps(rowB + i * 8 + 4));
+         _mm_storeu_ps(dst + i * 4, _mm_mul_ps(sum, quarter));
+      }
+   }
+
+   return i;
+}
+#endif
+
+
 /**
  * Average together two rows of a source image to produce a single new
  * row in the dest image.  It's legal for the two source rows to point
@@ -170,12 +338,38 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
  * dest width or two times the dest width.
  * \param datatype  GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_FLOAT, etc.
  * \param comps  number of components per pixel (1..4)
+ * \param srgbMask  for GL_UNSIGNED_BYTE, the sRGB encoded components
  */
 static void
-do_row(GLenum datatype, GLuint comps, GLint srcWidth,
+do_row(GLenum datatype, GLuint comps, GLbitfield srgbMask, GLint srcWidth,
        const GLvoid *srcRowA, const GLvoid *srcRowB,
        GLint dstWidth, GLvoid *dstRow)
 {
+   if (srgbMask) {
+      assert(datatype == GL_UNSIGNED_BYTE);
+      do_row_srgb(comps, srgbMask, srcWidth, srcRowA, srcRowB,
+                  dstWidth, dstRow);
+      return;
+   }
+
+#ifdef __SSE2__
+   if (srcWidth != dstWidth) {
+      const GLuint n = do_row_sse2(datatype, comps, srcRowA, srcRowB,
+                                   dstWidth, dstRow);
+      if (n > 0) {
+         const GLint bpt = bytes_per_pixel(datatype, comps);
+
+         srcRowA = (const GLubyte *) srcRowA + 2 * n * bpt;
+         srcRowB = (const GLubyte *) srcRowB + 2 * n * bpt;
+         dstRow = (GLubyte *) dstRow + n * bpt;
+         srcWidth -= 2 * n;
+         dstWidth -= n;
+         if (dstWidth == 0)
+            return;
+      }
+   }
+#endif
+
    const GLuint k0 = (srcWidth == dstWidth) ? 0 : 1;
    const GLuint colStride = (srcWidth == dstWidth) ? 1 : 2;
 
@@ -796,6 +990,7 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
  * \param datatype  GL pixel type \c GL_UNSIGNED_BYTE, \c GL_UNSIGNED_SHORT,
  *                  \c GL_FLOAT, etc.
  * \param comps     number of components per pixel (1..4)
+ * \param srgbMask  for \c GL_UNSIGNED_BYTE, the sRGB encoded components
  * \param srcWidth  Width of a row in the source data
  * \param srcRowA   Pointer to one of the rows of source data
  * \param srcRowB   Pointer to one of the rows of source data
@@ -805,7 +1000,7 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
  * \param srcRowA   Pointer to the row of destination data
  */
 static void
-do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
+do_row_3D(GLenum datatype, GLuint comps, GLbitfield srgbMask, GLint srcWidth,
           const GLvoid *srcRowA, const GLvoid *srcRowB,
           const GLvoid *srcRowC, const GLvoid *srcRowD,
           GLint dstWidth, GLvoid *dstRow)
@@ -817,6 +1012,41 @@ do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
    assert(comps >= 1);
    assert(comps <= 4);
 
+   if (srgbMask) {
+      DECLARE_ROW_POINTERS0(GLubyte);
+      GLuint c;
+
+      assert(datatype == GL_UNSIGNED_BYTE);
+
+      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+           i++, j += colStride, k += colStride) {
+         for (c = 0; c < comps; c++) {
+            const GLuint jc = j * comps + c, kc = k * comps + c;
+
+            if (srgbMask & (1 << c)) {
+               const GLfloat sum =
+                  util_format_srgb_8unorm_to_linear_float(rowA[jc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowA[kc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowB[jc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowB[kc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowC[jc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowC[kc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowD[jc]) +
+                  util_format_srgb_8unorm_to_linear_float(rowD[kc]);
+               dst[i * comps + c] =
+                  util_format_linear_float_to_srgb_8unorm(sum * 0.125F);
+            }
+            else {
+               dst[i * comps + c] = FILTER_SUM_3D(rowA[jc], rowA[kc],
+                                                  rowB[jc], rowB[kc],
+                                                  rowC[jc], rowC[kc],
+                                                  rowD[jc], rowD[kc]);
+            }
+         }
+      }
+      return;
+   }
+
    if ((datatype == GL_UNSIGNED_BYTE) && (comps == 4)) {
       DECLARE_ROW_POINTERS(GLubyte, 4);
 
@@ -1438,8 +1668,8 @@ do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
  */
 
 static void
-make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
-               GLint srcWidth, const GLubyte *srcPtr,
+make_1d_mipmap(GLenum datatype, GLuint comps, GLbitfield srgbMask,
+               GLint border, GLint srcWidth, const GLubyte *srcPtr,
                GLint dstWidth, GLubyte *dstPtr)
 {
    const GLint bpt = bytes_per_pixel(datatype, comps);
@@ -1451,7 +1681,7 @@ make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
    dst = dstPtr + border * bpt;
 
    /* we just duplicate the input row, kind of hack, saves code */
-   do_row(datatype, comps, srcWidth - 2 * border, src, src,
+   do_row(datatype, comps, srgbMask, srcWidth - 2 * border, src, src,
           dstWidth - 2 * border, dst);
 
    if (border) {
@@ -1467,9 +1697,43 @@ make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
 }
 
 
+struct mipmap_2d_rows_job {
+   GLenum datatype;
+   GLuint comps;
+   GLbitfield srgbMask;
+   GLint srcWidthNB, dstWidthNB;
+   const GLubyte *srcA, *srcB;
+   GLint srcRowStep, srcRowStride;
+   GLubyte *dst;
+   GLint dstRowStride;
+};
+
 static void
-make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
-               GLint srcWidth, GLint srcHeight,
+make_2d_mipmap_rows(void *data, unsigned first_row, unsigned num_rows)
+{
+   const struct mipmap_2d_rows_job *job = data;
+   /* The bands of a large image can start more than 2 GB into it. */
+   const ptrdiff_t srcOffset =
+      (ptrdiff_t) first_row * job->srcRowStep * job->srcRowStride;
+   const ptrdiff_t dstOffset = (ptrdiff_t) first_row * job->dstRowStride;
+   const GLubyte *srcA = job->srcA + srcOffset;
+   const GLubyte *srcB = job->srcB + srcOffset;
+   GLubyte *dst = job->dst + dstOffset;
+   unsigned row;
+
+   for (row = 0; row < num_rows; row++) {
+      do_row(job->datatype, job->comps, job->srgbMask, job->srcWidthNB,
+             srcA, srcB, job->dstWidthNB, dst);
+      srcA += job->srcRowStep * job->srcRowStride;
+      srcB += job->srcRowStep * job->srcRowStride;
+      dst += job->dstRowStride;
+   }
+}
+
+
+static void
+make_2d_mipmap(GLenum datatype, GLuint comps, GLbitfield srgbMask,
+               GLint border, GLint srcWidth, GLint srcHeight,
                const GLubyte *srcPtr, GLint srcRowStride,
                GLint dstWidth, GLint dstHeight,
                GLubyte *dstPtr, GLint dstRowStride)
@@ -1497,12 +1761,25 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
 
    dst = dstPtr + border * ((dstWidth + 1) * bpt);
 
-   for (row = 0; row < dstHeightNB; row++) {
-      do_row(datatype, comps, srcWidthNB, srcA, srcB,
-             dstWidthNB, dst);
-      srcA += srcRowStep * srcRowStride;
-      srcB += srcRowStep * srcRowStride;
-      dst += dstRowStride;
+   if (dstHeightNB > 0) {
+      struct mipmap_2d_rows_job job = {
+         .datatype = datatype,
+         .comps = comps,
+         .srgbMask = srgbMask,
+         .srcWidthNB = srcWidthNB,
+         .dstWidthNB = dstWidthNB,
+         .srcA = srcA,
+         .srcB = srcB,
+         .srcRowStep = srcRowStep,
+         .srcRowStride = srcRowStride,
+         .dst = dst,
+         .dstRowStride = dstRowStride,
+      };
+
+      util_parallel_rows(dstHeightNB,
+                         DIV_ROUND_UP(MIPMAP_PARALLEL_MIN_TEXELS,
+                                      MAX2(dstWidthNB, 1)),
+                         make_2d_mipmap_rows, &job);
    }
 
    /* This is ugly but probably won't be used much */
@@ -1522,12 +1799,12 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
       memcpy(dstPtr + (dstWidth * dstHeight - 1) * bpt,
              srcPtr + (srcWidth * srcHeight - 1) * bpt, bpt);
       /* lower border */
-      do_row(datatype, comps, srcWidthNB,
+      do_row(datatype, comps, srgbMask, srcWidthNB,
              srcPtr + bpt,
              srcPtr + bpt,
              dstWidthNB, dstPtr + bpt);
       /* upper border */
-      do_row(datatype, comps, srcWidthNB,
+      do_row(datatype, comps, srgbMask, srcWidthNB,
              srcPtr + (srcWidth * (srcHeight - 1) + 1) * bpt,
              srcPtr + (srcWidth * (srcHeight - 1) + 1) * bpt,
              dstWidthNB,
@@ -1545,11 +1822,11 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
       else {
          /* average two src pixels each dest pixel */
          for (row = 0; row < dstHeightNB; row += 2) {
-            do_row(datatype, comps, 1,
+            do_row(datatype, comps, srgbMask, 1,
                    srcPtr + (srcWidth * (row * 2 + 1)) * bpt,
                    srcPtr + (srcWidth * (row * 2 + 2)) * bpt,
                    1, dstPtr + (dstWidth * row + 1) * bpt);
-            do_row(datatype, comps, 1,
+            do_row(datatype, comps, srgbMask, 1,
                    srcPtr + (srcWidth * (row * 2 + 1) + srcWidth - 1) * bpt,
                    srcPtr + (srcWidth * (row * 2 + 2) + srcWidth - 1) * bpt,
                    1, dstPtr + (dstWidth * row + 1 + dstWidth - 1) * bpt);
@@ -1559,9 +1836,70 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
 }
 
 
+struct mipmap_3d_images_job {
+   GLenum datatype;
+   GLuint comps;
+   GLbitfield srgbMask;
+   GLint border, bpt;
+   GLint srcWidthNB, dstWidthNB, dstHeightNB;
+   const GLubyte **srcPtr;
+   GLint srcRowStride, srcImageOffset, srcRowOffset;
+   GLubyte **dstPtr;
+   GLint dstRowStride;
+};
+
+static void
+make_3d_mipmap_images(void *data, unsigned first_img, unsigned num_imgs)
+{
+   const struct mipmap_3d_images_job *job = data;
+   const GLint border = job->border;
+   const GLint bpt = job->bpt;
+   const GLint srcRowStride = job->srcRowStride;
+   const GLint srcRowOffset = job->srcRowOffset;
+   const GLint dstRowStride = job->dstRowStride;
+   unsigned img;
+   GLint row;
+
+   for (img = first_img; img < first_img + num_imgs; img++) {
+      /* first source image pointer, skipping border */
+      const GLubyte *imgSrcA = job->srcPtr[img * 2 + border]
+         + srcRowStride * border + bpt * border;
+      /* second source image pointer, skipping border */
+      const GLubyte *imgSrcB =
+         job->srcPtr[img * 2 + job->srcImageOffset + border]
+         + srcRowStride * border + bpt * border;
+
+      /* address of the dest image, skipping border */
+      GLubyte *imgDst = job->dstPtr[img + border]
+         + dstRowStride * border + bpt * border;
+
+      /* setup the four source row pointers and the dest row pointer */
+      const GLubyte *srcImgARowA = imgSrcA;
+      const GLubyte *srcImgARowB = imgSrcA + srcRowOffset;
+      const GLubyte *srcImgBRowA = imgSrcB;
+      const GLubyte *srcImgBRowB = imgSrcB + srcRowOffset;
+      GLubyte *dstImgRow = imgDst;
+
+      for (row = 0; row < job->dstHeightNB; row++) {
+         do_row_3D(job->datatype, job->comps, job->srgbMask, job->srcWidthNB,
+                   srcImgARowA, srcImgARowB,
+                   srcImgBRowA, srcImgBRowB,
+                   job->dstWidthNB, dstImgRow);
+
+         /* advance to next rows */
+         srcImgARowA += srcRowStride + srcRowOffset;
+         srcImgARowB += srcRowStride + srcRowOffset;
+         srcImgBRowA += srcRowStride + srcRowOffset;
+         srcImgBRowB += srcRowStride + srcRowOffset;
+         dstImgRow += dstRowStride;
+      }
+   }
+}
+
+
 static void
-make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
-               GLint srcWidth, GLint srcHeight, GLint srcDepth,
+make_3d_mipmap(GLenum datatype, GLuint comps, GLbitfield srgbMask,
+               GLint border, GLint srcWidth, GLint srcHeight, GLint srcDepth,
                const GLubyte **srcPtr, GLint srcRowStride,
                GLint dstWidth, GLint dstHeight, GLint dstDepth,
                GLubyte **dstPtr, GLint dstRowStride)
@@ -1572,7 +1910,7 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
    const GLint dstWidthNB = dstWidth - 2 * border;
    const GLint dstHeightNB = dstHeight - 2 * border;
    const GLint dstDepthNB = dstDepth - 2 * border;
-   GLint img, row;
+   GLint img;
    GLint bytesPerSrcImage, bytesPerDstImage;
    GLint srcImageOffset, srcRowOffset;
 
@@ -1600,49 +1938,39 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
           srcWidth, srcHeight, srcDepth, dstWidth, dstHeight, dstDepth);
    */
 
-   for (img = 0; img < dstDepthNB; img++) {
-      /* first source image pointer, skipping border */
-      const GLubyte *imgSrcA = srcPtr[img * 2 + border]
-         + srcRowStride * border + bpt * border;
-      /* second source image pointer, skipping border */
-      const GLubyte *imgSrcB = srcPtr[img * 2 + srcImageOffset + border]
-         + srcRowStride * border + bpt * border;
-
-      /* address of the dest image, skipping border */
-      GLubyte *imgDst = dstPtr[img + border]
-         + dstRowStride * border + bpt * border;
-
-      /* setup the four source row pointers and the dest row pointer */
-      const GLubyte *srcImgARowA = imgSrcA;
-      const GLubyte *srcImgARowB = imgSrcA + srcRowOffset;
-      const GLubyte *srcImgBRowA = imgSrcB;
-      const GLubyte *srcImgBRowB = imgSrcB + srcRowOffset;
-      GLubyte *dstImgRow = imgDst;
-
-      for (row = 0; row < dstHeightNB; row++) {
-         do_row_3D(datatype, comps, srcWidthNB,
-                   srcImgARowA, srcImgARowB,
-                   srcImgBRowA, srcImgBRowB,
-                   dstWidthNB, dstImgRow);
-
-         /* advance to next rows */
-         srcImgARowA += srcRowStride + srcRowOffset;
-         srcImgARowB += srcRowStride + srcRowOffset;
-         srcImgBRowA += srcRowStride + srcRowOffset;
-         srcImgBRowB += srcRowStride + srcRowOffset;
-         dstImgRow += dstRowStride;
-      }
+   if (dstDepthNB > 0) {
+      struct mipmap_3d_images_job job = {
+         .datatype = datatype,
+         .comps = comps,
+         .srgbMask = srgbMask,
+         .border = border,
+         .bpt = bpt,
+         .srcWidthNB = srcWidthNB,
+         .dstWidthNB = dstWidthNB,
+         .dstHeightNB = dstHeightNB,
+         .srcPtr = srcPtr,
+         .srcRowStride = srcRowStride,
+         .srcImageOffset = srcImageOffset,
+         .srcRowOffset = srcRowOffset,
+         .dstPtr = dstPtr,
+         .dstRowStride = dstRowStride,
+      };
+
+      util_parallel_rows(dstDepthNB,
+                         DIV_ROUND_UP(MIPMAP_PARALLEL_MIN_TEXELS,
+                                      MAX2(dstWidthNB * dstHeightNB, 1)),
+                         make_3d_mipmap_images, &job);
    }
 
 
    /* Luckily we can leverage the make_2d_mipmap() function here! */
    if (border > 0) {
       /* do front border image */
-      make_2d_mipmap(datatype, comps, 1,
+      make_2d_mipmap(datatype, comps, srgbMask, 1,
                      srcWidth, srcHeight, srcPtr[0], srcRowStride,
                      dstWidth, dstHeight, dstPtr[0], dstRowStride);
       /* do back border image */
-      make_2d_mipmap(datatype, comps, 1,
+      make_2d_mipmap(datatype, comps, srgbMask, 1,
                      srcWidth, srcHeight, srcPtr[srcDepth - 1], srcRowStride,
                      dstWidth, dstHeight, dstPtr[dstDepth - 1], dstRowStride);
 
@@ -1685,7 +2013,7 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
             srcA = srcPtr[img * 2 + 0];
             srcB = srcPtr[img * 2 + srcImageOffset];
             dst = dstPtr[img];
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgbMask, 1, srcA, srcB, 1, dst);
 
             /* do border along [img][row=dstHeight-1][col=0] */
             srcA = srcPtr[img * 2 + 0]
@@ -1693,19 +2021,19 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
             srcB = srcPtr[img * 2 + srcImageOffset]
                + (srcHeight - 1) * srcRowStride;
             dst = dstPtr[img] + (dstHeight - 1) * dstRowStride;
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgbMask, 1, srcA, srcB, 1, dst);
 
             /* do border along [img][row=0][col=dstWidth-1] */
             srcA = srcPtr[img * 2 + 0] + (srcWidth - 1) * bpt;
             srcB = srcPtr[img * 2 + srcImageOffset] + (srcWidth - 1) * bpt;
             dst = dstPtr[img] + (dstWidth - 1) * bpt;
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgbMask, 1, srcA, srcB, 1, dst);
 
             /* do border along [img][row=dstHeight-1][col=dstWidth-1] */
             srcA = srcPtr[img * 2 + 0] + (bytesPerSrcImage - bpt);
             srcB = srcPtr[img * 2 + srcImageOffset] + (bytesPerSrcImage - bpt);
             dst = dstPtr[img] + (bytesPerDstImage - bpt);
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgbMask, 1, srcA, srcB, 1, dst);
          }
       }
    }
@@ -1715,6 +2043,8 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
 /**
  * Down-sample a texture image to produce the next lower mipmap level.
  * \param comps  components per texel (1, 2, 3 or 4)
+ * \param srgbMask  components which are sRGB encoded and filtered in linear
+ *                  space, only supported with GL_UNSIGNED_BYTE
  * \param srcData  array[slice] of pointers to source image slices
  * \param dstData  array[slice] of pointers to dest image slices
  * \param srcRowStride  stride between source rows, in bytes
@@ -1723,6 +2053,7 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
 void
 _mesa_generate_mipmap_level(GLenum target,
                             GLenum datatype, GLuint comps,
+                            GLbitfield srgbMask,
                             GLint border,
                             GLint srcWidth, GLint srcHeight, GLint srcDepth,
                             const GLubyte **srcData,
@@ -1735,7 +2066,7 @@ _mesa_generate_mipmap_level(GLenum target,
 
    switch (target) {
    case GL_TEXTURE_1D:
-      make_1d_mipmap(datatype, comps, border,
+      make_1d_mipmap(datatype, comps, srgbMask, border,
                      srcWidth, srcData[0],
                      dstWidth, dstData[0]);
       break;
@@ -1746,12 +2077,12 @@ _mesa_generate_mipmap_level(GLenum target,
    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-      make_2d_mipmap(datatype, comps, border,
+      make_2d_mipmap(datatype, comps, srgbMask, border,
                      srcWidth, srcHeight, srcData[0], srcRowStride,
                      dstWidth, dstHeight, dstData[0], dstRowStride);
       break;
    case GL_TEXTURE_3D:
-      make_3d_mipmap(datatype, comps, border,
+      make_3d_mipmap(datatype, comps, srgbMask, border,
                      srcWidth, srcHeight, srcDepth,
                      srcData, srcRowStride,
                      dstWidth, dstHeight, dstDepth,
@@ -1761,7 +2092,7 @@ _mesa_generate_mipmap_level(GLenum target,
       assert(srcHeight == 1);
       assert(dstHeight == 1);
       for (i = 0; i < dstDepth; i++) {
-         make_1d_mipmap(datatype, comps, border,
+         make_1d_mipmap(datatype, comps, srgbMask, border,
                         srcWidth, srcData[i],
                         dstWidth, dstData[i]);
       }
@@ -1769,7 +2100,7 @@ _mesa_generate_mipmap_level(GLenum target,
    case GL_TEXTURE_2D_ARRAY_EXT:
    case GL_TEXTURE_CUBE_MAP_ARRAY:
       for (i = 0; i < dstDepth; i++) {
-         make_2d_mipmap(datatype, comps, border,
+         make_2d_mipmap(datatype, comps, srgbMask, border,
                         srcWidth, srcHeight, srcData[i], srcRowStride,
                         dstWidth, dstHeight, dstData[i], dstRowStride);
       }
@@ -1951,9 +2282,14 @@ generate_mipmap_uncompressed(struct gl_context *ctx, GLenum target,
    GLuint level;
    GLenum datatype;
    GLuint comps;
+   GLbitfield srgbMask = 0;
 
    _mesa_uncompressed_format_to_type_and_comps(srcImage->TexFormat, &datatype, &comps);
 
+   /* Filter sRGB encoded color channels in linear space. */
+   if (datatype == GL_UNSIGNED_BYTE)
+      srgbMask = srgb_component_mask(srcImage->TexFormat, comps);
+
    for (level = texObj->BaseLevel; level < maxLevel; level++) {
       /* generate image[level+1] from image[level] */
       struct gl_texture_image *srcImage, *dstImage;
@@ -2027,7 +2363,8 @@ generate_mipmap_uncompressed(struct gl_context *ctx, GLenum target,
 
       if (success) {
          /* generate one mipmap level (for 1D/2D/3D/array/etc texture) */
-         _mesa_generate_mipmap_level(target, datatype, comps, border,
+         _mesa_generate_mipmap_level(target, datatype, comps, srgbMask,
+                                     border,
                                      srcWidth, srcHeight, srcDepth,
                                      (const GLubyte **) srcMaps, srcRowStride,
                                      dstWidth, dstHeight, dstDepth,
@@ -2191,7 +2528,8 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
       /* Rescale src image to dest image.
        * This will loop over the slices of a 2D array.
        */
-      _mesa_generate_mipmap_level(target, temp_datatype, components, border,
+      _mesa_generate_mipmap_level(target, temp_datatype, components, 0,
+                                  border,
                                   srcWidth, srcHeight, srcDepth,
                                   (const GLubyte **) temp_src_slices,
                                   temp_src_row_stride,
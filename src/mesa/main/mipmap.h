@@ -39,6 +39,7 @@ _mesa_compute_num_levels(struct gl_context *ctx,
 extern void
 _mesa_generate_mipmap_level(GLenum target,
                             GLenum datatype, GLuint comps,
+                            GLbitfield srgbMask,
                             GLint border,
                             GLint srcWidth, GLint srcHeight, GLint srcDepth,
                             const GLubyte **srcData,
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2020 Mesa contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "main/sse_swizzle.h"
+#include "main/formats.h"
+#include <smmintrin.h>
+#include <assert.h>
+
+/**
+ * Swizzle 3 or 4 channel ubyte pixels into 4 channel ubyte pixels.
+ *
+ * This is the SSE counterpart of the ubyte -> ubyte case of
+ * _mesa_swizzle_and_convert(), which covers the common RGB/RGBA/BGRA
+ * uploads into RGBA8 textures.  Four pixels are shuffled per iteration
+ * with a single PSHUFB; ZERO and ONE swizzles are folded into the shuffle
+ * mask and an OR mask respectively.
+ */
+void
+_mesa_swizzle_ubyte_to_rgba(uint8_t *dst, const uint8_t *src,
+                            int num_src_channels, const uint8_t swizzle[4],
+                            uint8_t one, int count)
+{
+   uint8_t tmp[6];
+   int8_t shuf[16];
+   uint8_t ones[16];
+   int i = 0, p, c;
+
+   assert(num_src_channels == 3 || num_src_channels == 4);
+
+   for (p = 0; p < 4; p++) {
+      for (c = 0; c < 4; c++) {
+         const uint8_t s = swizzle[c];
+
+         assert(s < num_src_channels || s > MESA_FORMAT_SWIZZLE_W);
+         shuf[p * 4 + c] = s <= MESA_FORMAT_SWIZZLE_W ?
+            p * num_src_channels + s : (int8_t) 0x80;
+         ones[p * 4 + c] = s == MESA_FORMAT_SWIZZLE_ONE ? one : 0;
+      }
+   }
+
+   const __m128i shuf4 = _mm_loadu_si128((const __m128i *) shuf);
+   const __m128i ones4 = _mm_loadu_si128((const __m128i *) ones);
+
+   if (num_src_channels == 4) {
+      for (; i + 4 <= count; i += 4) {
+         __m128i pix = _mm_loadu_si128((const __m128i *) (src + i * 4));
+         pix = _mm_or_si128(_mm_shuffle_epi8(pix, shuf4), ones4);
+         _mm_storeu_si128((__m128i *) (dst + i * 4), pix);
+      }
+   } else {
+      /* Each iteration consumes 12 bytes but loads 16, so stop while at
+       * least 6 pixels remain to never read past the end of the row.
+       */
+      for (; i + 6 <= count; i += 4) {
+         __m128i pix = _mm_loadu_si128((const __m128i *) (src + i * 3));
+         pix = _mm_or_si128(_mm_shuffle_epi8(pix, shuf4), ones4);
+         _mm_storeu_si128((__m128i *) (dst + i * 4), pix);
+      }
+   }
+
+   tmp[MESA_FORMAT_SWIZZLE_ZERO] = 0;
+   tmp[MESA_FORMAT_SWIZZLE_ONE] = one;
+   for (; i < count; i++) {
+      const uint8_t *s = src + i * num_src_channels;
+
+      for (c = 0; c < num_src_channels; c++)
+         tmp[c] = s[c];
+      if (num_src_channels == 3)
+         tmp[3] = 0;
+
+      for (c = 0; c < 4; c++)
+         dst[i * 4 + c] = swizzle[c] < 6 ? tmp[swizzle[c]] : 0;
+   }
+}
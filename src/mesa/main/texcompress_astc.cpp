@@ -36,6 +36,7 @@
 #include "texcompress_astc.h"
 #include "macros.h"
 #include "util/half_float.h"
+#include "util/u_parallel.h"
 #include <stdio.h>
 #include <cstdlib>  // for abort() on windows
 
@@ -1814,34 +1815,23 @@ decode_error::type Block::calculate_colour_endpoints_size()
    return decode_error::invalid_colour_endpoints_size;
 }
 
-/**
- * Decode ASTC 2D LDR texture data.
- *
- * \param src_width in pixels
- * \param src_height in pixels
- * \param dst_stride in bytes
- */
-extern "C" void
-_mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
-                         unsigned dst_stride,
-                         const uint8_t *src_row,
-                         unsigned src_stride,
-                         unsigned src_width,
-                         unsigned src_height,
-                         mesa_format format)
+static void
+unpack_astc_2d_ldr_blocks(void *data,
+                          uint8_t *dst_row,
+                          unsigned dst_stride,
+                          const uint8_t *src_row,
+                          unsigned src_stride,
+                          unsigned src_width,
+                          unsigned src_height)
 {
-   assert(_mesa_is_format_astc_2d(format));
-   bool srgb = _mesa_is_format_srgb(format);
-
-   unsigned blk_w, blk_h;
-   _mesa_get_format_block_size(format, &blk_w, &blk_h);
+   const Decoder &dec = *(const Decoder *) data;
+   const unsigned blk_w = dec.block_w;
+   const unsigned blk_h = dec.block_h;
 
    const unsigned block_size = 16;
    unsigned x_blocks = (src_width + blk_w - 1) / blk_w;
    unsigned y_blocks = (src_height + blk_h - 1) / blk_h;
 
-   Decoder dec(blk_w, blk_h, 1, srgb, true);
-
    for (unsigned y = 0; y < y_blocks; ++y) {
       for (unsigned x = 0; x < x_blocks; ++x) {
          /* Same size as the largest block. */
@@ -1870,3 +1860,35 @@ _mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
       dst_row += dst_stride * blk_h;
    }
 }
+
+/**
+ * Decode ASTC 2D LDR texture data.
+ *
+ * Bands of block rows are decoded in parallel for large images.
+ *
+ * \param src_width in pixels
+ * \param src_height in pixels
+ * \param dst_stride in bytes
+ */
+extern "C" void
+_mesa_unpack_astc_2d_ldr(uint8_t *dst_row,
+                         unsigned dst_stride,
+                         const uint8_t *src_row,
+                         unsigned src_stride,
+                         unsigned src_width,
+                         unsigned src_height,
+                         mesa_format format)
+{
+   assert(_mesa_is_format_astc_2d(format));
+   bool srgb = _mesa_is_format_srgb(format);
+
+   unsigned blk_w, blk_h;
+   _mesa_get_format_block_size(format, &blk_w, &blk_h);
+
+   Decoder dec(blk_w, blk_h, 1, srgb, true);
+
+   util_parallel_unpack_blocks(unpack_astc_2d_ldr_blocks, &dec,
+                               dst_row, dst_stride,
+                               src_row, src_stride,
+                               src_width, src_height, blk_w, blk_h);
+}
@@ -30,6 +30,7 @@
 
 #include "util/format_srgb.h"
 #include "util/half_float.h"
+#include "util/u_parallel.h"
 #include "macros.h"
 
 #define BLOCK_SIZE 4
@@ -796,18 +797,14 @@ decompress_rgba_unorm_block(int src_width, int src_height,
 }
 
 static void
-decompress_rgba_unorm(int width, int height,
-                      const uint8_t *src, int src_rowstride,
-                      uint8_t *dst, int dst_rowstride)
+decompress_rgba_unorm_blocks(void *data,
+                             uint8_t *dst, unsigned dst_rowstride,
+                             const uint8_t *src, unsigned src_rowstride,
+                             unsigned width, unsigned height)
 {
-   int src_row_diff;
+   const int src_row_diff = src_rowstride - ((width + 3) & ~3) * 4;
    int y, x;
 
-   if (src_rowstride >= width * 4)
-      src_row_diff = src_rowstride - ((width + 3) & ~3) * 4;
-   else
-      src_row_diff = 0;
-
    for (y = 0; y < height; y += BLOCK_SIZE) {
       for (x = 0; x < width; x += BLOCK_SIZE) {
          decompress_rgba_unorm_block(MIN2(width - x, BLOCK_SIZE),
@@ -820,6 +817,21 @@ decompress_rgba_unorm(int width, int height,
       src += src_row_diff;
    }
 }
+
+static void
+decompress_rgba_unorm(int width, int height,
+                      const uint8_t *src, int src_rowstride,
+                      uint8_t *dst, int dst_rowstride)
+{
+   /* Smaller strides mean the rows of blocks are tightly packed */
+   if (src_rowstride < width * 4)
+      src_rowstride = ((width + 3) & ~3) * 4;
+
+   util_parallel_unpack_blocks(decompress_rgba_unorm_blocks, NULL,
+                               dst, dst_rowstride,
+                               src, src_rowstride,
+                               width, height, BLOCK_SIZE, BLOCK_SIZE);
+}
 #endif // BPTC_BLOCK_DECODE
 
 static int32_t
@@ -1145,18 +1157,16 @@ decompress_rgb_float_block(unsigned src_width, unsigned src_height,
 }
 
 static void
-decompress_rgb_float(int width, int height,
-                      const uint8_t *src, int src_rowstride,
-                      float *dst, int dst_rowstride, bool is_signed)
+decompress_rgb_float_blocks(void *data,
+                            uint8_t *dst_row, unsigned dst_rowstride,
+                            const uint8_t *src, unsigned src_rowstride,
+                            unsigned width, unsigned height)
 {
-   int src_row_diff;
+   const bool is_signed = *(const bool *) data;
+   const int src_row_diff = src_rowstride - ((width + 3) & ~3) * 4;
+   float *dst = (float *) dst_row;
    int y, x;
 
-   if (src_rowstride >= width * 4)
-      src_row_diff = src_rowstride - ((width + 3) & ~3) * 4;
-   else
-      src_row_diff = 0;
-
    for (y = 0; y < height; y += BLOCK_SIZE) {
       for (x = 0; x < width; x += BLOCK_SIZE) {
          decompress_rgb_float_block(MIN2(width - x, BLOCK_SIZE),
@@ -1170,6 +1180,21 @@ decompress_rgb_float(int width, int height,
       src += src_row_diff;
    }
 }
+
+static void
+decompress_rgb_float(int width, int height,
+                      const uint8_t *src, int src_rowstride,
+                      float *dst, int dst_rowstride, bool is_signed)
+{
+   /* Smaller strides mean the rows of blocks are tightly packed */
+   if (src_rowstride < width * 4)
+      src_rowstride = ((width + 3) & ~3) * 4;
+
+   util_parallel_unpack_blocks(decompress_rgb_float_blocks, &is_signed,
+                               (uint8_t *) dst, dst_rowstride,
+                               src, src_rowstride,
+                               width, height, BLOCK_SIZE, BLOCK_SIZE);
+}
 #endif // BPTC_BLOCK_DECODE
 
 static void
@@ -1453,18 +1478,14 @@ compress_rgba_unorm_block(int src_width, int src_height,
 }
 
 static void
-compress_rgba_unorm(int width, int height,
-                    const uint8_t *src, int src_rowstride,
-                    uint8_t *dst, int dst_rowstride)
+compress_rgba_unorm_blocks(void *data,
+                           uint8_t *dst, unsigned dst_rowstride,
+                           const uint8_t *src, unsigned src_rowstride,
+                           unsigned width, unsigned height)
 {
-   int dst_row_diff;
+   const int dst_row_diff = dst_rowstride - ((width + 3) & ~3) * 4;
    int y, x;
 
-   if (dst_rowstride >= width * 4)
-      dst_row_diff = dst_rowstride - ((width + 3) & ~3) * 4;
-   else
-      dst_row_diff = 0;
-
    for (y = 0; y < height; y += BLOCK_SIZE) {
       for (x = 0; x < width; x += BLOCK_SIZE) {
          compress_rgba_unorm_block(MIN2(width - x, BLOCK_SIZE),
@@ -1478,6 +1499,21 @@ compress_rgba_unorm(int width, int height,
    }
 }
 
+static void
+compress_rgba_unorm(int width, int height,
+                    const uint8_t *src, int src_rowstride,
+                    uint8_t *dst, int dst_rowstride)
+{
+   /* Smaller strides mean the rows of blocks are tightly packed */
+   if (dst_rowstride < width * 4)
+      dst_rowstride = ((width + 3) & ~3) * 4;
+
+   util_parallel_pack_blocks(compress_rgba_unorm_blocks, NULL,
+                             dst, dst_rowstride,
+                             src, src_rowstride,
+                             width, height, BLOCK_SIZE, BLOCK_SIZE);
+}
+
 static float
 get_average_luminance_float(int width, int height,
                             const float *src, int src_rowstride)
@@ -1716,19 +1752,16 @@ compress_rgb_float_block(int src_width, int src_height,
 }
 
 static void
-compress_rgb_float(int width, int height,
-                   const float *src, int src_rowstride,
-                   uint8_t *dst, int dst_rowstride,
-                   bool is_signed)
+compress_rgb_float_blocks(void *data,
+                          uint8_t *dst, unsigned dst_rowstride,
+                          const uint8_t *src_row, unsigned src_rowstride,
+                          unsigned width, unsigned height)
 {
-   int dst_row_diff;
+   const bool is_signed = *(const bool *) data;
+   const int dst_row_diff = dst_rowstride - ((width + 3) & ~3) * 4;
+   const float *src = (const float *) src_row;
    int y, x;
 
-   if (dst_rowstride >= width * 4)
-      dst_row_diff = dst_rowstride - ((width + 3) & ~3) * 4;
-   else
-      dst_row_diff = 0;
-
    for (y = 0; y < height; y += BLOCK_SIZE) {
       for (x = 0; x < width; x += BLOCK_SIZE) {
          compress_rgb_float_block(MIN2(width - x, BLOCK_SIZE),
@@ -1744,4 +1777,20 @@ compress_rgb_float(int width, int height,
    }
 }
 
+static void
+compress_rgb_float(int width, int height,
+                   const float *src, int src_rowstride,
+                   uint8_t *dst, int dst_rowstride,
+                   bool is_signed)
+{
+   /* Smaller strides mean the rows of blocks are tightly packed */
+   if (dst_rowstride < width * 4)
+      dst_rowstride = ((width + 3) & ~3) * 4;
+
+   util_parallel_pack_blocks(compress_rgb_float_blocks, &is_signed,
+                             dst, dst_rowstride,
+                             (const uint8_t *) src, src_rowstride,
+                             width, height, BLOCK_SIZE, BLOCK_SIZE);
+}
+
 #endif
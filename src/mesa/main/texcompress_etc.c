@@ -45,6 +45,7 @@
 #include "macros.h"
 #include "format_unpack.h"
 #include "util/format_srgb.h"
+#include "util/u_parallel.h"
 
 
 struct etc2_block {
@@ -115,6 +116,18 @@ _mesa_texstore_etc1_rgb8(UNUSED_TEXSTORE_PARAMS)
 }
 
 
+/** util_parallel_unpack_blocks() callback for a band of ETC1 blocks. */
+static void
+etc1_unpack_rgba8888_blocks(void *data,
+                            uint8_t *dst_row, unsigned dst_stride,
+                            const uint8_t *src_row, unsigned src_stride,
+                            unsigned width, unsigned height)
+{
+   etc1_unpack_rgba8888(dst_row, dst_stride,
+                        src_row, src_stride,
+                        width, height);
+}
+
 /**
  * Decode texture data in format `MESA_FORMAT_ETC1_RGB8` to
  * `MESA_FORMAT_ABGR8888`.
@@ -142,9 +155,10 @@ _mesa_etc1_unpack_rgba8888(uint8_t *dst_row,
                            unsigned src_width,
                            unsigned src_height)
 {
-   etc1_unpack_rgba8888(dst_row, dst_stride,
-                        src_row, src_stride,
-                        src_width, src_height);
+   util_parallel_unpack_blocks(etc1_unpack_rgba8888_blocks, NULL,
+                               dst_row, dst_stride,
+                               src_row, src_stride,
+                               src_width, src_height, 4, 4);
 }
 
 static uint8_t
@@ -1191,37 +1205,21 @@ _mesa_texstore_etc2_srgb8_punchthrough_alpha1(UNUSED_TEXSTORE_PARAMS)
 }
 
 
-/**
- * Decode texture data in any one of following formats:
- * `MESA_FORMAT_ETC2_RGB8`
- * `MESA_FORMAT_ETC2_SRGB8`
- * `MESA_FORMAT_ETC2_RGBA8_EAC`
- * `MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC`
- * `MESA_FORMAT_ETC2_R11_EAC`
- * `MESA_FORMAT_ETC2_RG11_EAC`
- * `MESA_FORMAT_ETC2_SIGNED_R11_EAC`
- * `MESA_FORMAT_ETC2_SIGNED_RG11_EAC`
- * `MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1`
- * `MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1`
- *
- * The size of the source data must be a multiple of the ETC2 block size
- * even if the texture image's dimensions are not aligned to 4.
- *
- * \param src_width in pixels
- * \param src_height in pixels
- * \param dst_stride in bytes
- */
+struct etc2_unpack_job {
+   mesa_format format;
+   bool bgra;
+};
 
-void
-_mesa_unpack_etc2_format(uint8_t *dst_row,
-                         unsigned dst_stride,
-                         const uint8_t *src_row,
-                         unsigned src_stride,
-                         unsigned src_width,
-                         unsigned src_height,
-			 mesa_format format,
-			 bool bgra)
+static void
+etc2_unpack_blocks(void *data,
+                   uint8_t *dst_row, unsigned dst_stride,
+                   const uint8_t *src_row, unsigned src_stride,
+                   unsigned src_width, unsigned src_height)
 {
+   const struct etc2_unpack_job *job = data;
+   const mesa_format format = job->format;
+   const bool bgra = job->bgra;
+
    if (format == MESA_FORMAT_ETC2_RGB8)
       etc2_unpack_rgb8(dst_row, dst_stride,
                        src_row, src_stride,
@@ -1264,6 +1262,48 @@ _mesa_unpack_etc2_format(uint8_t *dst_row,
 					    src_width, src_height, bgra);
 }
 
+/**
+ * Decode texture data in any one of following formats:
+ * `MESA_FORMAT_ETC2_RGB8`
+ * `MESA_FORMAT_ETC2_SRGB8`
+ * `MESA_FORMAT_ETC2_RGBA8_EAC`
+ * `MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC`
+ * `MESA_FORMAT_ETC2_R11_EAC`
+ * `MESA_FORMAT_ETC2_RG11_EAC`
+ * `MESA_FORMAT_ETC2_SIGNED_R11_EAC`
+ * `MESA_FORMAT_ETC2_SIGNED_RG11_EAC`
+ * `MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1`
+ * `MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1`
+ *
+ * The size of the source data must be a multiple of the ETC2 block size
+ * even if the texture image's dimensions are not aligned to 4.
+ *
+ * \param src_width in pixels
+ * \param src_height in pixels
+ * \param dst_stride in bytes
+ */
+void
+_mesa_unpack_etc2_format(uint8_t *dst_row,
+                         unsigned dst_stride,
+                         const uint8_t *src_row,
+                         unsigned src_stride,
+                         unsigned src_width,
+                         unsigned src_height,
+                         mesa_format format,
+                         bool bgra)
+{
+   struct etc2_unpack_job job = {
+      .format = format,
+      .bgra = bgra,
+   };
+
+   /* Blocks are independent, so decode bands of block rows in parallel. */
+   util_parallel_unpack_blocks(etc2_unpack_blocks, &job,
+                               dst_row, dst_stride,
+                               src_row, src_stride,
+                               src_width, src_height, 4, 4);
+}
+
 
 
 static void
@@ -31,6 +31,11 @@
 #include <GL/gl.h>
 #endif
 
+#include <string.h>
+
+#include "util/u_debug.h"
+#include "util/u_parallel.h"
+
 typedef GLubyte GLchan;
 #define UBYTE_TO_CHAN(b)  (b)
 #define CHAN_MAX 255
@@ -501,7 +506,8 @@ static void storedxtencodedblock( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
 }
 
 static void encodedxtcolorblockfaster( GLubyte *blkaddr, GLubyte srccolors[4][4][4],
-                         GLint numxpixels, GLint numypixels, GLuint type )
+                         GLint numxpixels, GLint numypixels, GLuint type,
+                         GLboolean fast )
 {
 /* simplistic approach. We need two base colors, simply use the "highest" and the "lowest" color
    present in the picture as base colors */
@@ -549,8 +555,9 @@ static void encodedxtcolorblockfaster( GLubyte *blkaddr, GLubyte srccolors[4][4]
    bestcolor[0] = basecolors[0];
    bestcolor[1] = basecolors[1];
 
-   /* try to find better base colors */
-   fancybasecolorsearch(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
+   /* try to find better base colors, unless only speed matters */
+   if (!fast)
+      fancybasecolorsearch(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
    /* find the best encoding for these colors, and store the result */
    storedxtencodedblock(blkaddr, srccolors, bestcolor, numxpixels, numypixels, type, haveAlpha);
 }
@@ -906,8 +913,8 @@ static void extractsrccolors( GLubyte srcpixels[4][4][4], const GLchan *srcaddr,
 }
 
 
-static void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *srcPixData,
-                     GLenum destFormat, GLubyte *dest, GLint dstRowStride)
+static void tx_compress_dxtn_rows(GLint srccomps, GLint width, GLint height, const GLubyte *srcPixData,
+                     GLenum destFormat, GLubyte *dest, GLint dstRowStride, GLboolean fast)
 {
       GLubyte *blkaddr = dest;
       GLubyte srcpixels[4][4][4];
@@ -931,7 +938,7 @@ static void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GL
             if (width > i + 3) numxpixels = 4;
             else numxpixels = width - i;
             extractsrccolors(srcpixels, srcaddr, width, numxpixels, numypixels, srccomps);
-            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat, fast);
             srcaddr += srccomps * numxpixels;
             blkaddr += 8;
          }
@@ -958,7 +965,7 @@ static void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GL
             *blkaddr++ = (srcpixels[2][2][3] >> 4) | (srcpixels[2][3][3] & 0xf0);
             *blkaddr++ = (srcpixels[3][0][3] >> 4) | (srcpixels[3][1][3] & 0xf0);
             *blkaddr++ = (srcpixels[3][2][3] >> 4) | (srcpixels[3][3][3] & 0xf0);
-            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat);
+            encodedxtcolorblockfaster(blkaddr, srcpixels, numxpixels, numypixels, destFormat, fast);
             srcaddr += srccomps * numxpixels;
             blkaddr += 8;
          }
@@ -978,7 +985,7 @@ static void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GL
             else numxpixels = width - i;
             extractsrccolors(srcpixels, srcaddr, width, numxpixels, numypixels, srccomps);
             encodedxt5alpha(blkaddr, srcpixels, numxpixels, numypixels);
-            encodedxtcolorblockfaster(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat);
+            encodedxtcolorblockfaster(blkaddr + 8, srcpixels, numxpixels, numypixels, destFormat, fast);
             srcaddr += srccomps * numxpixels;
             blkaddr += 16;
          }
@@ -991,4 +998,52 @@ static void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GL
    }
 }
 
+DEBUG_GET_ONCE_OPTION(texcompress_quality, "MESA_TEXCOMPRESS_QUALITY", "normal")
+
+struct tx_compress_dxtn_job {
+   GLint srccomps;
+   GLenum destFormat;
+   GLboolean fast;
+};
+
+static void tx_compress_dxtn_blocks(void *data, uint8_t *dst, unsigned dst_stride,
+                                    const uint8_t *src, UNUSED unsigned src_stride,
+                                    unsigned width, unsigned height)
+{
+   const struct tx_compress_dxtn_job *job = data;
+
+   tx_compress_dxtn_rows(job->srccomps, width, height, src,
+                         job->destFormat, dst, dst_stride, job->fast);
+}
+
+/* MESA_TEXCOMPRESS_QUALITY=fast skips the base color refinement, which is
+   most of the encoding time, at some cost in quality. Large images are
+   split into bands of block rows which are encoded in parallel. */
+static void tx_compress_dxtn(GLint srccomps, GLint width, GLint height, const GLubyte *srcPixData,
+                     GLenum destFormat, GLubyte *dest, GLint dstRowStride)
+{
+   const char *quality = debug_get_option_texcompress_quality();
+   struct tx_compress_dxtn_job job;
+   GLint blockRowSize;
+
+   job.srccomps = srccomps;
+   job.destFormat = destFormat;
+   job.fast = quality && strcmp(quality, "fast") == 0;
+
+   if (destFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+       destFormat == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)
+      blockRowSize = ((width + 3) & ~3) * 2;
+   else
+      blockRowSize = ((width + 3) & ~3) * 4;
+
+   /* smaller strides mean the rows of blocks are tightly packed */
+   if (dstRowStride < blockRowSize)
+      dstRowStride = blockRowSize;
+
+   util_parallel_pack_blocks(tx_compress_dxtn_blocks, &job,
+                             dest, dstRowStride,
+                             srcPixData, width * srccomps,
+                             width, height, 4, 4);
+}
+
 #endif
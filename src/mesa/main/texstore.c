@@ -76,6 +76,7 @@
 #include "pixeltransfer.h"
 #include "util/format_rgb9e5.h"
 #include "util/format_r11g11b10f.h"
+#include "util/u_parallel.h"
 
 
 enum {
@@ -668,6 +669,63 @@ texstore_compressed(TEXSTORE_PARAMS)
                            srcFormat, srcType, srcAddr, srcPacking);
 }
 
+/**
+ * Images with at least this many texels per slice are split into row
+ * bands which are converted in parallel.  Smaller images aren't worth the
+ * job submission and wakeup overhead.
+ */
+#define TEXSTORE_PARALLEL_MIN_TEXELS (256 * 1024)
+
+struct texstore_convert_job {
+   uint8_t *dst;
+   uint32_t dst_format;
+   size_t dst_stride;
+   uint8_t *src;
+   uint32_t src_format;
+   size_t src_stride;
+   size_t width;
+   uint8_t *rebase_swizzle;
+};
+
+static void
+texstore_convert_rows(void *data, unsigned first_row, unsigned num_rows)
+{
+   struct texstore_convert_job *job = data;
+
+   _mesa_format_convert(job->dst + first_row * job->dst_stride,
+                        job->dst_format, job->dst_stride,
+                        job->src + first_row * job->src_stride,
+                        job->src_format, job->src_stride,
+                        job->width, num_rows, job->rebase_swizzle);
+}
+
+/**
+ * Wrapper around _mesa_format_convert() which converts large images in
+ * bands of rows on several threads.  Every row is independent so the
+ * result is identical to a single _mesa_format_convert() call.
+ */
+static void
+texstore_format_convert(void *dst, uint32_t dst_format, size_t dst_stride,
+                        void *src, uint32_t src_format, size_t src_stride,
+                        size_t width, size_t height, uint8_t *rebase_swizzle)
+{
+   struct texstore_convert_job job = {
+      .dst = dst,
+      .dst_format = dst_format,
+      .dst_stride = dst_stride,
+      .src = src,
+      .src_format = src_format,
+      .src_stride = src_stride,
+      .width = width,
+      .rebase_swizzle = rebase_swizzle,
+   };
+
+   const unsigned min_rows =
+      DIV_ROUND_UP(TEXSTORE_PARALLEL_MIN_TEXELS, MAX2(width, 1));
+
+   util_parallel_rows(height, min_rows, texstore_convert_rows, &job);
+}
+
 static GLboolean
 texstore_rgba(TEXSTORE_PARAMS)
 {
@@ -772,9 +830,10 @@ texstore_rgba(TEXSTORE_PARAMS)
       src = (GLubyte *) srcAddr;
       dst = (GLubyte *) tempRGBA;
       for (img = 0; img < srcDepth; img++) {
-         _mesa_format_convert(dst, RGBA32_FLOAT, 4 * srcWidth * sizeof(float),
-                              src, srcMesaFormat, srcRowStride,
-                              srcWidth, srcHeight, NULL);
+         texstore_format_convert(dst, RGBA32_FLOAT,
+                                 4 * srcWidth * sizeof(float),
+                                 src, srcMesaFormat, srcRowStride,
+                                 srcWidth, srcHeight, NULL);
          src += srcHeight * srcRowStride;
          dst += srcHeight * 4 * srcWidth * sizeof(float);
       }
@@ -808,10 +867,10 @@ texstore_rgba(TEXSTORE_PARAMS)
    }
 
    for (img = 0; img < srcDepth; img++) {
-      _mesa_format_convert(dstSlices[img], dstFormat, dstRowStride,
-                           src, srcMesaFormat, srcRowStride,
-                           srcWidth, srcHeight,
-                           needRebase ? rebaseSwizzle : NULL);
+      texstore_format_convert(dstSlices[img], dstFormat, dstRowStride,
+                              src, srcMesaFormat, srcRowStride,
+                              srcWidth, srcHeight,
+                              needRebase ? rebaseSwizzle : NULL);
       src += srcHeight * srcRowStride;
    }
 
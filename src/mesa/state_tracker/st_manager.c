@@ -492,6 +492,8 @@ st_framebuffer_create(struct st_context *st,
    }
 
    _mesa_initialize_window_framebuffer(&stfb->Base, &mode);
+   if (stfbi->y_0_bottom)
+      stfb->Base.FlipY = false;
 
    stfb->iface = stfbi;
    stfb->iface_ID = stfbi->ID;
@@ -1,6 +1,7 @@
 #include "pipe/p_compiler.h"
 #include "util/u_debug.h"
 #include "util/u_math.h"
+#include "util/u_parallel.h"
 #include "util/format/u_format_etc.h"
 
 /* define etc1_parse_block and etc. */
@@ -10,10 +11,18 @@
 #undef TAG
 #undef UINT8_TYPE
 
+static void
+etc1_unpack_rgba8888_blocks(void *data, uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   etc1_unpack_rgba8888(dst_row, dst_stride, src_row, src_stride, width, height);
+}
+
 void
 util_format_etc1_rgb8_unpack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
 {
-   etc1_unpack_rgba8888(dst_row, dst_stride, src_row, src_stride, width, height);
+   util_parallel_unpack_blocks(etc1_unpack_rgba8888_blocks, NULL,
+                               dst_row, dst_stride, src_row, src_stride,
+                               width, height, 4, 4);
 }
 
 void
@@ -26,6 +26,7 @@
 #include "util/format/u_format.h"
 #include "util/format/u_format_rgtc.h"
 #include "util/u_math.h"
+#include "util/u_parallel.h"
 #include "util/rgtc.h"
 
 void
@@ -62,9 +63,11 @@ util_format_rgtc1_unorm_unpack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride
    }
 }
 
-void
-util_format_rgtc1_unorm_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, 
-					 unsigned src_stride, unsigned width, unsigned height)
+static void
+rgtc1_unorm_pack_rgba_8unorm_blocks(UNUSED void *data,
+                                    uint8_t *dst_row, unsigned dst_stride,
+                                    const uint8_t *src_row, unsigned src_stride,
+                                    unsigned width, unsigned height)
 {
    const unsigned bw = 4, bh = 4, bytes_per_block = 8;
    unsigned x, y, i, j;
@@ -85,6 +88,15 @@ util_format_rgtc1_unorm_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
    }
 }
 
+void
+util_format_rgtc1_unorm_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, 
+					 unsigned src_stride, unsigned width, unsigned height)
+{
+   util_parallel_pack_blocks(rgtc1_unorm_pack_rgba_8unorm_blocks, NULL,
+                             dst_row, dst_stride, src_row, src_stride,
+                             width, height, 4, 4);
+}
+
 void
 util_format_rgtc1_unorm_unpack_rgba_float(void *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
 {
@@ -259,8 +271,11 @@ util_format_rgtc2_unorm_unpack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride
    }
 }
 
-void
-util_format_rgtc2_unorm_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+static void
+rgtc2_unorm_pack_rgba_8unorm_blocks(UNUSED void *data,
+                                    uint8_t *dst_row, unsigned dst_stride,
+                                    const uint8_t *src_row, unsigned src_stride,
+                                    unsigned width, unsigned height)
 {
    const unsigned bw = 4, bh = 4, bytes_per_block = 16;
    unsigned x, y, i, j;
@@ -284,6 +299,14 @@ util_format_rgtc2_unorm_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
    }
 }
 
+void
+util_format_rgtc2_unorm_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, const uint8_t *src_row, unsigned src_stride, unsigned width, unsigned height)
+{
+   util_parallel_pack_blocks(rgtc2_unorm_pack_rgba_8unorm_blocks, NULL,
+                             dst_row, dst_stride, src_row, src_stride,
+                             width, height, 4, 4);
+}
+
 void
 util_format_rxtc2_unorm_pack_rgba_float(uint8_t *dst_row, unsigned dst_stride, const float *src_row, unsigned src_stride, unsigned width, unsigned height, unsigned chan2off)
 {
@@ -27,6 +27,7 @@
 #include "util/format/u_format_s3tc.h"
 #include "util/format_srgb.h"
 #include "util/u_math.h"
+#include "util/u_parallel.h"
 #include "../../mesa/main/texcompress_s3tc_tmp.h"
 
 
@@ -280,13 +281,22 @@ util_format_dxt5_rgba_unpack_rgba_float(void *dst_row, unsigned dst_stride,
  * Block compression.
  */
 
-static inline void
-util_format_dxtn_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
-                                  const uint8_t *src, unsigned src_stride,
-                                  unsigned width, unsigned height,
-                                  enum util_format_dxtn format,
-                                  unsigned block_size, boolean srgb)
+struct dxtn_pack_job {
+   enum util_format_dxtn format;
+   unsigned block_size;
+   boolean srgb;
+};
+
+static void
+util_format_dxtn_pack_rgba_8unorm_blocks(void *data,
+                                         uint8_t *dst_row, unsigned dst_stride,
+                                         const uint8_t *src, unsigned src_stride,
+                                         unsigned width, unsigned height)
 {
+   const struct dxtn_pack_job *job = data;
+   const enum util_format_dxtn format = job->format;
+   const unsigned block_size = job->block_size;
+   const boolean srgb = job->srgb;
    const unsigned bw = 4, bh = 4, comps = 4;
    unsigned x, y, i, j, k;
    for(y = 0; y < height; y += bh) {
@@ -315,7 +325,20 @@ util_format_dxtn_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
       }
       dst_row += dst_stride / sizeof(*dst_row);
    }
+}
+
+static inline void
+util_format_dxtn_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
+                                  const uint8_t *src, unsigned src_stride,
+                                  unsigned width, unsigned height,
+                                  enum util_format_dxtn format,
+                                  unsigned block_size, boolean srgb)
+{
+   struct dxtn_pack_job job = { format, block_size, srgb };
 
+   util_parallel_pack_blocks(util_format_dxtn_pack_rgba_8unorm_blocks, &job,
+                             dst_row, dst_stride, src, src_stride,
+                             width, height, 4, 4);
 }
 
 void
@@ -933,6 +933,47 @@ ra_allocate(struct ra_graph *g)
    return ra_select(g);
 }
 
+/**
+ * Colors the nodes greedily in the given order, skipping ra_simplify().
+ *
+ * \p order must contain every node of the graph exactly once.  When the
+ * graph is an interval graph (live ranges on a linear instruction order, as
+ * for SSA values) and \p order is sorted by the start of each range, this
+ * is the reverse of a perfect elimination order, and the greedy coloring is
+ * optimal for classes of single registers.  With wider or overlapping
+ * classes it may fail where ra_allocate() would not, so callers should fall
+ * back to ra_allocate() when this returns false.
+ */
+bool
+ra_allocate_in_order(struct ra_graph *g, const unsigned int *order)
+{
+   memset(g->tmp.in_stack, 0, BITSET_WORDS(g->count) * sizeof(BITSET_WORD));
+   memset(g->tmp.reg_assigned, 0,
+          BITSET_WORDS(g->count) * sizeof(BITSET_WORD));
+
+   for (unsigned int n = 0; n < g->count; n++) {
+      g->nodes[n].reg = g->nodes[n].forced_reg;
+      if (g->nodes[n].reg != NO_REG)
+         BITSET_SET(g->tmp.reg_assigned, n);
+   }
+
+   /* ra_select() pops from the top, so push in reverse: */
+   g->tmp.stack_count = 0;
+   for (unsigned int i = g->count; i-- > 0;) {
+      unsigned int n = order[i];
+
+      assert(n < g->count && !BITSET_TEST(g->tmp.in_stack, n));
+      if (BITSET_TEST(g->tmp.reg_assigned, n))
+         continue;
+
+      g->tmp.stack[g->tmp.stack_count++] = n;
+      BITSET_SET(g->tmp.in_stack, n);
+   }
+   g->tmp.stack_optimistic_start = UINT_MAX;
+
+   return ra_select(g);
+}
+
 unsigned int
 ra_get_node_reg(struct ra_graph *g, unsigned int n)
 {
@@ -119,6 +119,7 @@ void ra_reset_node_interference(struct ra_graph *g, unsigned int n);
 
 /** @{ Graph-coloring register allocation */
 bool ra_allocate(struct ra_graph *g);
+bool ra_allocate_in_order(struct ra_graph *g, const unsigned int *order);
 
 #define NO_REG ~0U
 /**
@@ -0,0 +1,235 @@
+/*
+ * Copyright © 2020 Mesa contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "u_parallel.h"
+
+#include "c11/threads.h"
+
+#include "util/debug.h"
+#include "util/macros.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_math.h"
+#include "util/u_queue.h"
+#include "util/u_thread.h"
+
+#define UTIL_PARALLEL_MAX_THREADS 16
+
+/**
+ * Minimum number of compressed blocks handed to a single job.  Block
+ * (de)compression is much more expensive per pixel than plain conversion,
+ * so this is far smaller than the pixel thresholds used by callers of
+ * util_parallel_rows().
+ */
+#define UTIL_PARALLEL_MIN_BLOCKS 256
+
+struct util_parallel_job {
+   struct util_queue_fence fence;
+   util_parallel_rows_func func;
+   void *data;
+   unsigned first_row;
+   unsigned num_rows;
+};
+
+static struct util_queue parallel_queue;
+static unsigned parallel_num_threads;
+static once_flag parallel_queue_once = ONCE_FLAG_INIT;
+
+static void
+parallel_queue_init(void)
+{
+   unsigned num_threads;
+
+   util_cpu_detect();
+
+   num_threads = env_var_as_unsigned("MESA_IMAGE_THREADS",
+                                     util_cpu_caps.nr_cpus);
+   num_threads = CLAMP(num_threads, 1, UTIL_PARALLEL_MAX_THREADS);
+
+   /* The calling thread always processes one band itself. */
+   if (num_threads > 1 &&
+       !util_queue_init(&parallel_queue, "mesaimg", UTIL_PARALLEL_MAX_THREADS,
+                        num_threads - 1, 0))
+      num_threads = 1;
+
+   parallel_num_threads = num_threads;
+}
+
+static bool
+is_parallel_worker(void)
+{
+   for (unsigned i = 0; i < parallel_queue.num_threads; i++) {
+      if (u_thread_is_self(parallel_queue.threads[i]))
+         return true;
+   }
+   return false;
+}
+
+static void
+parallel_job_execute(void *data, int thread_index)
+{
+   struct util_parallel_job *job = data;
+
+   job->func(job->data, job->first_row, job->num_rows);
+}
+
+void
+util_parallel_rows(unsigned num_rows, unsigned min_rows_per_job,
+                   util_parallel_rows_func func, void *data)
+{
+   struct util_parallel_job jobs[UTIL_PARALLEL_MAX_THREADS];
+   unsigned num_jobs, rows_per_job, row, i;
+
+   if (min_rows_per_job == 0)
+      min_rows_per_job = 1;
+
+   if (num_rows < 2 * min_rows_per_job) {
+      func(data, 0, num_rows);
+      return;
+   }
+
+   call_once(&parallel_queue_once, parallel_queue_init);
+
+   num_jobs = MIN2(parallel_num_threads, num_rows / min_rows_per_job);
+
+   /* Waiting on the queue from one of its own workers could deadlock. */
+   if (num_jobs <= 1 || is_parallel_worker()) {
+      func(data, 0, num_rows);
+      return;
+   }
+
+   rows_per_job = DIV_ROUND_UP(num_rows, num_jobs);
+   num_jobs = DIV_ROUND_UP(num_rows, rows_per_job);
+
+   for (i = 0, row = 0; i < num_jobs; i++, row += rows_per_job) {
+      struct util_parallel_job *job = &jobs[i];
+
+      job->func = func;
+      job->data = data;
+      job->first_row = row;
+      job->num_rows = MIN2(rows_per_job, num_rows - row);
+
+      if (i < num_jobs - 1) {
+         util_queue_fence_init(&job->fence);
+         util_queue_add_job(&parallel_queue, job, &job->fence,
+                            parallel_job_execute, NULL, 0);
+      }
+   }
+
+   parallel_job_execute(&jobs[num_jobs - 1], -1);
+
+   for (i = 0; i < num_jobs - 1; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+}
+
+struct parallel_blocks_job {
+   util_parallel_blocks_func func;
+   void *data;
+   uint8_t *dst_row;
+   unsigned dst_stride;
+   size_t dst_block_row_pitch;
+   const uint8_t *src_row;
+   unsigned src_stride;
+   size_t src_block_row_pitch;
+   unsigned width, height;
+   unsigned block_h;
+};
+
+static void
+parallel_blocks_rows(void *data, unsigned first_row, unsigned num_rows)
+{
+   const struct parallel_blocks_job *job = data;
+   const unsigned y = first_row * job->block_h;
+
+   job->func(job->data,
+             job->dst_row + first_row * job->dst_block_row_pitch,
+             job->dst_stride,
+             job->src_row + first_row * job->src_block_row_pitch,
+             job->src_stride,
+             job->width, MIN2(num_rows * job->block_h, job->height - y));
+}
+
+static void
+parallel_blocks(struct parallel_blocks_job *job, unsigned block_w)
+{
+   const unsigned blocks_x = DIV_ROUND_UP(job->width, block_w);
+   const unsigned blocks_y = DIV_ROUND_UP(job->height, job->block_h);
+
+   if (blocks_x == 0) {
+      parallel_blocks_rows(job, 0, blocks_y);
+      return;
+   }
+
+   util_parallel_rows(blocks_y,
+                      DIV_ROUND_UP(UTIL_PARALLEL_MIN_BLOCKS, blocks_x),
+                      parallel_blocks_rows, job);
+}
+
+void
+util_parallel_unpack_blocks(util_parallel_blocks_func func, void *data,
+                            uint8_t *dst_row, unsigned dst_stride,
+                            const uint8_t *src_row, unsigned src_stride,
+                            unsigned width, unsigned height,
+                            unsigned block_w, unsigned block_h)
+{
+   struct parallel_blocks_job job = {
+      .func = func,
+      .data = data,
+      .dst_row = dst_row,
+      .dst_stride = dst_stride,
+      .dst_block_row_pitch = (size_t) dst_stride * block_h,
+      .src_row = src_row,
+      .src_stride = src_stride,
+      .src_block_row_pitch = src_stride,
+      .width = width,
+      .height = height,
+      .block_h = block_h,
+   };
+
+   parallel_blocks(&job, block_w);
+}
+
+void
+util_parallel_pack_blocks(util_parallel_blocks_func func, void *data,
+                          uint8_t *dst_row, unsigned dst_stride,
+                          const uint8_t *src_row, unsigned src_stride,
+                          unsigned width, unsigned height,
+                          unsigned block_w, unsigned block_h)
+{
+   struct parallel_blocks_job job = {
+      .func = func,
+      .data = data,
+      .dst_row = dst_row,
+      .dst_stride = dst_stride,
+      .dst_block_row_pitch = dst_stride,
+      .src_row = src_row,
+      .src_stride = src_stride,
+      .src_block_row_pitch = (size_t) src_stride * block_h,
+      .width = width,
+      .height = height,
+      .block_h = block_h,
+   };
+
+   parallel_blocks(&job, block_w);
+}
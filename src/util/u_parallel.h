@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2020 Mesa contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Process-wide thread pool for splitting CPU-side image processing
+ * (format conversion, mipmap generation, texture (de)compression, tiled
+ * copies) into independent bands of rows.
+ *
+ * The pool is created on first use.  Its size defaults to the number of
+ * CPUs and can be overridden with the MESA_IMAGE_THREADS environment
+ * variable; MESA_IMAGE_THREADS=1 runs everything on the calling thread.
+ */
+
+#ifndef U_PARALLEL_H
+#define U_PARALLEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Process rows [first_row, first_row + num_rows).  Must not touch any
+ * state shared with other bands without its own synchronization.
+ */
+typedef void (*util_parallel_rows_func)(void *data, unsigned first_row,
+                                        unsigned num_rows);
+
+/**
+ * Call \p func over [0, num_rows), split into contiguous bands of at least
+ * \p min_rows_per_job rows which are processed concurrently.  The calling
+ * thread processes one band itself and returns once all bands are done.
+ *
+ * Small inputs, single-CPU systems and calls made from one of the pool's
+ * own worker threads simply run \p func once over the whole range.
+ */
+void
+util_parallel_rows(unsigned num_rows, unsigned min_rows_per_job,
+                   util_parallel_rows_func func, void *data);
+
+/**
+ * Block (de)compression callback, processing a \p width x \p height pixel
+ * region in the argument convention of the util_format
+ * unpack_rgba_8unorm/pack_rgba_8unorm functions.
+ */
+typedef void (*util_parallel_blocks_func)(void *data,
+                                          uint8_t *dst_row,
+                                          unsigned dst_stride,
+                                          const uint8_t *src_row,
+                                          unsigned src_stride,
+                                          unsigned width,
+                                          unsigned height);
+
+/**
+ * Decompress a \p width x \p height image of \p block_w x \p block_h
+ * blocks, splitting it into bands of block rows processed in parallel.
+ * \p src_stride is the distance between block rows, \p dst_stride the
+ * distance between pixel rows.
+ */
+void
+util_parallel_unpack_blocks(util_parallel_blocks_func func, void *data,
+                            uint8_t *dst_row, unsigned dst_stride,
+                            const uint8_t *src_row, unsigned src_stride,
+                            unsigned width, unsigned height,
+                            unsigned block_w, unsigned block_h);
+
+/**
+ * Compression counterpart of util_parallel_unpack_blocks(): \p src_stride
+ * is the distance between pixel rows, \p dst_stride the distance between
+ * block rows.
+ */
+void
+util_parallel_pack_blocks(util_parallel_blocks_func func, void *data,
+                          uint8_t *dst_row, unsigned dst_stride,
+                          const uint8_t *src_row, unsigned src_stride,
+                          unsigned width, unsigned height,
+                          unsigned block_w, unsigned block_h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* U_PARALLEL_H */